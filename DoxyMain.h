@@ -20,13 +20,22 @@
 /// \example test/smoke_timelog.cpp
 /// \example test/smoke_timestamp.cpp
 /// \example test/test_atomix.cpp
+/// \example test/test_compress.cpp
 /// \example test/test_expand_env.cpp
 /// \example test/test_ezargs.cpp
 /// \example test/test_ezscape.cpp
+/// \example test/test_fa.cpp
+/// \example test/test_fileasmem.cpp
+/// \example test/test_hash64.cpp
+/// \example test/test_intervals.cpp
 /// \example test/test_lexbase.cpp
 /// \example test/test_logger.cpp
+/// \example test/test_lr1.cpp
+/// \example test/test_memio.cpp
 /// \example test/test_paralog.cpp
+/// \example test/test_parascan.cpp
 /// \example test/test_PO.cpp
+/// \example test/test_serialize.cpp
 /// \example test/test_unicodecvt.cpp
 /// \example parsergen/ParserGen/main.cpp
 /// \example parsergen/ParserGen/GrammarStrip.cpp
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Intervals.h"  // bux::C_Intervals<>, bux::IntervalPt<>
+#include <algorithm>    // std::min()
+#include <array>        // std::array<>
+#include <cstdint>      // std::uint16_t, std::uint32_t, std::uint64_t
+#include <type_traits>  // std::is_signed_v<>
+#include <utility>      // std::pair<>
+#include <vector>       // std::vector<>
+
+namespace bux {
+
+//
+//      Types
+//
+class C_CodePointSet
+/*! Immutable set of Unicode code points as a three-level bitmap trie, answering contains() in O(1)
+    with no more than three dependent loads. The code space is split into 136 blocks of 128 words
+    of 64 bits, and identical words as well as identical blocks are stored once, so that even sets
+    of thousands of ranges, e.g. all letters, take only tens of KB. Code points below 128 are
+    looked up in a flat bitmap first.
+*/
+{
+public:
+
+    // Types
+    typedef std::pair<std::uint32_t,std::uint32_t> C_Range;
+
+    // Nonvirtuals
+    C_CodePointSet() { build({}); }
+    template<IntervalPt T>
+    explicit C_CodePointSet(const C_Intervals<T> &src);
+        ///< Values of \em src out of <tt>[0,0x10FFFF]</tt> are ignored
+    std::size_t bytes() const noexcept;
+        ///< Memory taken by the trie
+    bool contains(char32_t c) const noexcept
+    {
+        if (c < 128)
+            return m_Ascii[c >> 6] >> (c & 63) & 1;
+        if (c > MAX_CODE_POINT)
+            return false;
+
+        return m_Leaves[m_Blocks[std::size_t(m_Top[c >> 13]) << 7 | (c >> 6 & 127)]] >> (c & 63) & 1;
+    }
+    C_Intervals<std::uint32_t> toIntervals() const;
+        ///< The same set back as intervals, e.g. to be passed to C_FA_Traits operations
+
+    // Class Constants
+    static constexpr std::uint32_t MAX_CODE_POINT = 0x10FFFF;
+
+private:
+
+    // Data
+    std::uint64_t                   m_Ascii[2];
+    std::array<std::uint16_t,136>   m_Top;      ///< Block of each 8192 code points
+    std::vector<std::uint16_t>      m_Blocks;   ///< Leaf of each 64 code points, 128 leaves a block
+    std::vector<std::uint64_t>      m_Leaves;   ///< Unique words of bits
+
+    // Nonvirtuals
+    void build(const std::vector<C_Range> &ranges);
+};
+
+//
+//      Implement Class Templates
+//
+template<IntervalPt T>
+C_CodePointSet::C_CodePointSet(const C_Intervals<T> &src)
+{
+    std::vector<C_Range> ranges;
+    ranges.reserve(src.size());
+    for (auto &i: src)
+    {
+        std::uint64_t first;
+        if constexpr (std::is_signed_v<T>)
+        {
+            if (i.second < 0)
+                continue;
+
+            first = i.first < 0? 0: std::uint64_t(i.first);
+        }
+        else
+            first = i.first;
+
+        if (first > MAX_CODE_POINT)
+            // Sorted
+            break;
+
+        ranges.emplace_back(std::uint32_t(first), std::uint32_t(std::min<std::uint64_t>(std::uint64_t(i.second), MAX_CODE_POINT)));
+    }
+    build(ranges);
+}
+
+} // namespace bux
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>      // std::size_t
+#include <iosfwd>       // Forwarded std::istream, std::ostream
+#include <string>       // std::string
+#include <string_view>  // std::string_view
+#include <tuple>        // std::tuple<>
+
+namespace bux {
+
+//
+//      Constants
+//
+constexpr size_t LZ_DEF_BLOCK_BYTES = size_t(1) << 20;
+
+//
+//      Functions
+//
+std::string lz_compress(std::string_view src);
+bool lz_decompress(std::string_view src, char *dst, size_t dstBytes) noexcept;
+
+size_t save_compressed_str(std::ostream &out, std::string_view s, size_t blockBytes = LZ_DEF_BLOCK_BYTES, unsigned threads = 0);
+std::tuple<std::string,bool> load_compressed_str(std::istream &in, unsigned threads = 0);
+
+} // namespace bux
@@ -2,14 +2,20 @@
 
 //  FA stands for Finite Automoton
 
-#include <algorithm>    // std::set_difference()
+#include <algorithm>    // std::sort(), std::unique(), std::lower_bound(), std::min_element(), std::count_if()
+#include <atomic>       // std::atomic<>
+#include <bit>          // std::countr_zero()
 #include <concepts>     // std::convertible_to<>, std::invocable<>
-#include <iterator>     // std::inserter()
-#include <list>         // std::list<>
+#include <cstdint>      // std::uint64_t
+#include <exception>    // std::exception_ptr, std::current_exception(), std::rethrow_exception()
+#include <functional>   // std::function<>
 #include <map>          // std::map<>
+#include <mutex>        // std::mutex, std::lock_guard<>
+#include <optional>     // std::optional<>
 #include <set>          // std::set<>
 #include <stdexcept>    // std::runtime_error
 #include <string>       // std::to_string()
+#include <thread>       // std::jthread, std::thread::hardware_concurrency()
 #include <vector>       // std::vector<>
 
 namespace bux {
@@ -17,25 +23,7 @@ namespace bux {
 //
 //      Types
 //
-class C_NfaState
-/*! State of NFA ( NFA is defined below )
-*/
-{
-public:
-
-    // Nonvirtuals
-    C_NfaState();
-    C_NfaState(const C_NfaState &a) = default;
-    C_NfaState &operator=(const C_NfaState &a) = default;
-    auto operator<=>(const C_NfaState &a) const { return id <=> a.id; }
-    bool operator==(const C_NfaState &a) const  { return id == a.id; }
-
-private:
-
-    // Data
-    unsigned                id;
-    static unsigned         nextId;
-};
+typedef unsigned C_NfaState;    ///< State of NFA ( NFA is defined below ), numbered from 0 in each NFA
 
 enum
 {
@@ -54,7 +42,9 @@ struct C_FA_Traits
     static bool isEmptyInput(const T_Inputs &src);
 };
 
-template<class T_Inputs, class T_Action, class C_Traits> class C_DFA;
+namespace Helper_ {
+template<class T_Inputs, class T_Action, class C_Traits> class C_NfaIndex;
+} // namespace Helper_
 
 template<class T_Inputs, class T_Action, class C_Traits = C_FA_Traits<T_Inputs>>
 class C_NFA
@@ -63,64 +53,146 @@ class C_NFA
     \param C_Traits Collection of compile-time decisions
 
     NFA stands for <em><B>N</B>ondeterministic <B>F</B>inite <B>A</B>utomoton</em>
+
+    Each NFA numbers its own states densely from the starting state 0, and renumbers states of
+    another NFA merged into it. No state is shared among NFAs, so that different NFAs can be built
+    by different threads at the same time.
 */
 {
 public:
 
     // Nonvirtuals
     C_NFA() = default;
-    C_NFA(const C_NFA &a);
-    C_NFA(C_NFA &&a);
+    C_NFA(const C_NFA &a) = default;
+    C_NFA(C_NFA &&a) = default;
     C_NFA(const T_Inputs &inputs);
-    void operator=(const C_NFA &a);
-    void operator=(C_NFA &&a);
+    C_NFA &operator=(const C_NFA &a) = default;
+    C_NFA &operator=(C_NFA &&a) = default;
     void operator|=(const C_NFA &a);
     void operator+=(const C_NFA &a) { (void)append(a); }
     void operator+=(const T_Inputs &inputs) { (void)append(inputs); }
     C_NFA &append(const C_NFA &a);
     C_NFA &append(const T_Inputs &inputs);
     C_NFA &changeTo(int options);
+    void clear() { *this = C_NFA{}; }
+        ///< Reset to the initial NFA with only the starting state
     template<class T> void setAction(T &&action);
     size_t totalFinalStates() const { return F.size(); }
+    size_t totalStates() const { return m_TotalStates; }
 
 private:
 
     // Types
-    struct C_FinalState: C_NfaState
+    struct C_FinalState
     {
         // Data
+        C_NfaState  m_State;
         T_Action    m_Tag;
-
-        // Nonvirtuals
-        C_FinalState() = default;
-        C_FinalState(const C_NfaState &a, const T_Action &tag): C_NfaState(a), m_Tag(tag) {}
     };
     typedef std::vector<C_FinalState> C_FinalStates;
 
-    struct C_NfaInputSet
+    struct C_Edge
     {
         // Data
-        T_Inputs        m_UserInputs;
+        C_NfaState      m_From;
+        C_NfaState      m_To;
+        T_Inputs        m_UserInputs;   ///< Empty if epsilon
         bool            m_Epsilon;
+    };
+    typedef std::vector<C_Edge> C_Edges;
+
+    // Data
+    static constexpr C_NfaState q0 = 0; // starting point index of Q
+    C_FinalStates       F;              // final states of Q
+    C_Edges             delta;          // transition relation, as a flat list of edges
+    C_NfaState          m_TotalStates{1};
+
+    // Nonvirtuals
+    void addEpsilon(C_NfaState from, C_NfaState to) { delta.push_back({from, to, {}, true}); }
+    void addInputs(C_NfaState from, C_NfaState to, const T_Inputs &inputs) { delta.push_back({from, to, inputs, false}); }
+    C_NfaState import(const C_NFA &a);
+    C_NfaState newState() { return m_TotalStates++; }
+
+    friend class Helper_::C_NfaIndex<T_Inputs,T_Action,C_Traits>;
+};
+
+namespace Helper_ {
+
+class C_ClassSet
+/*! Bitset of input classes
+*/
+{
+public:
+
+    // Nonvirtuals
+    explicit C_ClassSet(size_t classes = 0): m_Bits((classes + 63) / 64) {}
+    void eachClass(std::invocable<size_t> auto get) const
+    {
+        for (size_t i = 0; i < m_Bits.size(); ++i)
+            for (auto t = m_Bits[i]; t; t &= t - 1)
+                get(i * 64 + size_t(std::countr_zero(t)));
+    }
+    void set(size_t c) { m_Bits[c / 64] |= std::uint64_t(1) << c % 64; }
+
+private:
+
+    // Data
+    std::vector<std::uint64_t>  m_Bits;
+};
+
+template<class T_Inputs, class T_Action, class C_Traits>
+class C_NfaIndex
+/*! Transitions of C_NFA indexed by state & input class, from which both C_DFA & C_LazyDFA make their states.
+    All const methods can be called concurrently with different scratches.
+*/
+{
+public:
 
-        // Ctor
-        C_NfaInputSet(bool epsilon = false): m_Epsilon(epsilon) {}
+    // Types
+    typedef std::vector<C_NfaState> C_Closure;      // Sorted NFA states
+    typedef std::map<C_Closure,C_ClassSet> C_Moves; // Input classes by NFA states they move to
+
+    struct C_Scratch
+    {
+        std::vector<char>       m_Visited;
+        std::vector<C_Closure>  m_Targets;  // Indexed by class
+        std::vector<size_t>     m_Touched;  // Classes with targets
     };
-    typedef std::map<C_NfaState,C_NfaInputSet> C_Transitions;
-    typedef std::map<C_NfaState,C_Transitions> C_TransitionMap;
 
     // Data
-    C_NfaState          q0;     // starting point index of Q
-    C_FinalStates       F;      // final states of Q
-    C_TransitionMap     delta;  // transition relation
+    std::vector<T_Inputs>       m_Classes;  // Disjoint input classes
 
     // Nonvirtuals
-    void gatherStates(std::set<C_NfaState> &usedStates) const;
-    const C_NFA &checkReuse(const std::set<C_NfaState> &usedStates, C_NFA &replacement) const;
+    explicit C_NfaIndex(const C_NFA<T_Inputs,T_Action,C_Traits> &nfa);
+    std::set<T_Action> actionsOf(const C_Closure &c) const;
+    void close(C_Closure &c, C_Scratch &scratch) const;
+        ///< Add to \em c all states reached by epsilon transitions & then sort it
+    void move(const C_Closure &src, C_Scratch &scratch, C_Moves &dst) const;
+        ///< Assign to \em dst NFA states moved to from \em src by each input class, before closure
+    C_Scratch newScratch() const { return {std::vector<char>(m_EpsStart.size()), std::vector<C_Closure>(m_Classes.size()), {}}; }
+    C_Closure startingClosure() const;
+
+private:
+
+    // Types
+    struct C_Move
+    {
+        C_NfaState      m_To;
+        C_ClassSet      m_Classes;
+    };
 
-    friend class C_DFA<T_Inputs,T_Action,C_Traits>;
+    // Data
+    std::vector<unsigned>                       m_EpsStart, m_MoveStart;    // Compressed sparse rows
+    std::vector<C_NfaState>                     m_EpsTo;
+    std::vector<C_Move>                         m_Moves;
+    std::vector<std::pair<C_NfaState,T_Action>> m_Finals;                   // Sorted by state
+
+    // Nonvirtuals
+    static void refineClasses(std::vector<T_Inputs> &classes, const T_Inputs &inputs);
 };
 
+} // namespace Helper_
+
 template<class T_Inputs, class T_Action, class C_Traits = C_FA_Traits<T_Inputs>>
 class C_DFA
 /*! \param T_Inputs Set of inputs
@@ -128,6 +200,9 @@ class C_DFA
     \param C_Traits Collection of compile-time decisions
 
     DFA stands for <em><B>D</B>eterministic <B>F</B>inite <B>A</B>utomoton</em>
+
+    The inputs of the source NFA are partitioned into disjoint classes once. Transitions are then kept
+    as class IDs, and the DFA is a dense table of next states indexed by state & class.
 */
 {
 public:
@@ -137,155 +212,191 @@ public:
 
     // Nonvirtuals
     template<class F_PickAction>
-    C_DFA(const C_NFA<T_Inputs,T_Action,C_Traits> &nfa, F_PickAction pickAction) requires
+    C_DFA(const C_NFA<T_Inputs,T_Action,C_Traits> &nfa, F_PickAction pickAction, unsigned threads = 0) requires
         requires (int tag, const C_Conflict &conflict) {
             { pickAction(tag, conflict) }->std::convertible_to<T_Action>;
         }
+    /*! \param [in] nfa Source NFA
+        \param [in] pickAction Called as <tt>pickAction(state, conflict)</tt> to pick one of the conflicting
+                    actions; returning <tt>T_Action()</tt> aborts the construction.
+        \param [in] threads Number of threads to expand DFA states; 0 for std::thread::hardware_concurrency()
+
+        The resulting DFA doesn't depend on \em threads, which only run the DFA's own code on distinct
+        objects, while \em pickAction and all \em C_Traits operations are called by this thread.
+    */
     {
-        C_FinalMap      Fraw;
-        C_TransitionMap deltaRaw;
-        auto n = nfa2dfa(nfa, Fraw, deltaRaw, pickAction);
-        minDfa(Fraw, deltaRaw, n, F, delta);
+        C_Finals            Fraw;
+        std::vector<int>    deltaRaw;
+        nfa2dfa(nfa, m_Classes, Fraw, deltaRaw, pickAction, threads);
+        minDfa(Fraw, deltaRaw, m_Classes.size(), F, delta);
+        m_TotalFinals = size_t(std::count_if(F.begin(), F.end(), [](const auto &i){ return i.has_value(); }));
     }
+    const std::vector<int> &classTable() const { return delta; }
+        ///< Next state, or -1 if none, of state \em s on inputs of class \em c is <tt>classTable()[s * totalClasses() + c]</tt>
     void eachFinalState(std::invocable<int,const T_Action&> auto get) const
     {
-        for (const auto &i: F)
-            get(i.first, i.second);
+        for (size_t i = 0; i < F.size(); ++i)
+            if (F[i])
+                get(int(i), *F[i]);
     }
     void eachTransition(std::invocable<int,const T_Inputs&,int> auto get) const
+    /*! Call <tt>get(from, inputs, to)</tt> for each state \em from and each state \em to it moves to,
+        in the ascending order of \em to.
+    */
     {
-        for (const auto &i: delta)
-            for (const auto &j: i.second)
-                get(i.first, j.second, j.first);
+        const auto n = m_Classes.size();
+        std::map<int,T_Inputs> row;
+        for (size_t i = 0; i < F.size(); ++i)
+        {
+            row.clear();
+            for (size_t c = 0; c < n; ++c)
+                if (const auto to = delta[i * n + c]; to >= 0)
+                    C_Traits::inputUnion(row[to], m_Classes[c]);
+
+            for (const auto &j: row)
+                get(int(i), j.second, j.first);
+        }
     }
+    const std::vector<T_Inputs> &inputClasses() const { return m_Classes; }
+        ///< Disjoint sets of inputs which the DFA never tells apart. Inputs out of them move nowhere.
     bool isFinal(int state, T_Action &action) const;
         // Return true and assign action if state is final; return false otherwise
+    int nextState(int state, size_t inputClass) const
+        { return delta[size_t(state) * m_Classes.size() + inputClass]; }
+        ///< Return -1 if \em state doesn't move on inputs of \em inputClass
     static constexpr int startingState() { return 0; }
-    size_t totalFinalStates() const { return F.size(); }
+    size_t totalClasses() const { return m_Classes.size(); }
+    size_t totalFinalStates() const { return m_TotalFinals; }
+    size_t totalStates() const { return F.size(); }
 
 private:
 
     // Types
-    typedef std::set<C_NfaState> C_NfaClosure;
+    typedef Helper_::C_NfaIndex<T_Inputs,T_Action,C_Traits> C_Index;
+    typedef std::vector<std::optional<T_Action>> C_Finals;  // Indexed by state
 
-    struct C_TaggedNfaClosure
-    {
-        C_NfaClosure        m_Closure;
-        int                 m_Tag;
+    //Data
+    std::vector<T_Inputs>   m_Classes;
+    C_Finals                F;
+    std::vector<int>        delta;          // Next states indexed by state * m_Classes.size() + class
+    size_t                  m_TotalFinals{};
 
-        C_TaggedNfaClosure(const C_NfaClosure &closure):
-            m_Closure(closure), m_Tag(0)
-            {}
-    };
+    // Nonvirtuals
+    static void minDfa(const C_Finals &Ffat, const std::vector<int> &deltaFat, size_t classes,
+        C_Finals &Fmin, std::vector<int> &deltaMin);
+    template<class F_PickAction>
+    static void nfa2dfa(const C_NFA<T_Inputs,T_Action,C_Traits> &nfa, std::vector<T_Inputs> &classes,
+        C_Finals &F, std::vector<int> &delta, F_PickAction pickAction, unsigned threads);
+
+    // Class Constants
+    static constexpr size_t MIN_STATES_PER_THREAD = 32;   // Frontier of DFA states too small to split is expanded serially
+};
 
-    typedef typename C_NFA<T_Inputs,T_Action,C_Traits>::C_TransitionMap C_SourceDelta;
-    typedef std::map<int,T_Action> C_FinalMap;
-    typedef std::map<int,T_Inputs> C_State2Inputs;
-    typedef std::map<int,C_State2Inputs> C_TransitionMap;
+template<class T_Inputs, class T_Action, class C_Traits = C_FA_Traits<T_Inputs>>
+class C_LazyDFA
+/*! \param T_Inputs Set of inputs
+    \param T_Action Type of action on final state.
+    \param C_Traits Collection of compile-time decisions
 
-    typedef std::set<int> C_DfaClosure;
-    struct C_TaggedDfaClosure
-    {
-        C_DfaClosure        m_Closure;
-        int                 m_Tag;
+    Run an NFA as its DFA without building the DFA upfront. DFA states are made from the NFA only when
+    they are reached, and are cached, in the spirit of RE2, within a memory budget. When the budget is
+    exceeded, the cache is flushed except the starting state & the state being left.
+
+    Its states are not minimized like those of C_DFA, and the cache makes it not thread-safe.
+*/
+{
+public:
+
+    // Types
+    typedef std::set<T_Action> C_Conflict;
+    typedef std::function<T_Action(int,const C_Conflict&)> F_PickAction;
+
+    // Nonvirtuals
+    C_LazyDFA(const C_NFA<T_Inputs,T_Action,C_Traits> &nfa, F_PickAction pickAction, size_t maxBytes = DEF_MAX_BYTES);
+    size_t cachedStates() const { return m_States.size(); }
+    size_t flushes() const { return m_Flushes; }
+    const std::vector<T_Inputs> &inputClasses() const { return m_Index.m_Classes; }
+        ///< Disjoint sets of inputs which the DFA never tells apart. Inputs out of them move nowhere.
+    bool isFinal(int state, T_Action &action) const;
+        // Return true and assign action if state is final; return false otherwise
+    int nextState(int state, size_t inputClass);
+    static constexpr int startingState() { return 0; }
+    size_t totalClasses() const { return m_Index.m_Classes.size(); }
 
-        C_TaggedDfaClosure()
-            {}
-        C_TaggedDfaClosure(const C_DfaClosure& closure): m_Closure(closure)
-            {}
+    // Class Constants
+    static constexpr size_t DEF_MAX_BYTES = 8 << 20;
+
+private:
+
+    // Types
+    typedef Helper_::C_NfaIndex<T_Inputs,T_Action,C_Traits> C_Index;
+    typedef typename C_Index::C_Closure C_Closure;
+
+    struct C_State
+    {
+        const C_Closure             *m_Closure;
+        std::optional<T_Action>     m_Action;
     };
-    typedef std::list<C_TaggedDfaClosure> C_DfaClosures;
-    typedef std::map<T_Action,C_DfaClosure> C_Action2Closure;
 
-    //Data
-    C_FinalMap              F;
-    C_TransitionMap         delta;
+    // Data
+    const C_Index                   m_Index;
+    const F_PickAction              m_PickAction;
+    const C_Closure                 m_Start;
+    std::map<C_Closure,int>         m_Ids;
+    std::vector<C_State>            m_States;
+    std::vector<int>                m_Next;     // Indexed by state * totalClasses() + class
+    typename C_Index::C_Scratch     m_Scratch;
+    typename C_Index::C_Moves       m_Moves;
+    const size_t                    m_MaxBytes;
+    size_t                          m_Bytes{};
+    size_t                          m_Flushes{};
 
     // Nonvirtuals
-    static void buildA2C(const C_FinalMap &Ffat, const C_DfaClosure &closure,
-        C_Action2Closure &a2c);
-    static void createClosure(C_NfaClosure &c, const C_SourceDelta &delta);
-    static typename C_DfaClosures::const_iterator findDfaClosure(const C_DfaClosures &Q, int state);
-    static void minDfa(const C_FinalMap &Ffat, const C_TransitionMap &deltaFat,
-        int totalFatStates, C_FinalMap &Fmin, C_TransitionMap &deltaMin);
-    template<class F_PickAction>
-    static int nfa2dfa(const C_NFA<T_Inputs,T_Action,C_Traits> &nfa, C_FinalMap &F,
-        C_TransitionMap &delta, F_PickAction pickAction);
-        // Return total of the resulting DFA states
+    int addState(C_Closure &&c);
+    size_t bytesOf(const C_Closure &c) const
+        { return c.size() * sizeof(C_NfaState) + totalClasses() * sizeof(int) + sizeof(C_State) + NODE_BYTES; }
+    void flush();
+
+    // Class Constants
+    static constexpr int UNKNOWN = -2;          // Yet to be made
+    static constexpr size_t NODE_BYTES = 64;    // Rough overhead per std::map node
 };
 
 //
 //      Class Template Implementations
 //
-template<class T_Inputs, class T_Action, class C_Traits>
-C_NFA<T_Inputs,T_Action,C_Traits>::C_NFA(const C_NFA &a):
-    q0(a.q0), F(a.F), delta(a.delta)
-{
-}
-
-template<class T_Inputs, class T_Action, class C_Traits>
-C_NFA<T_Inputs,T_Action,C_Traits>::C_NFA(C_NFA &&a): q0(a.q0)
-{
-    F.swap(a.F);
-    delta.swap(a.delta);
-}
-
 template<class T_Inputs, class T_Action, class C_Traits>
 C_NFA<T_Inputs,T_Action,C_Traits>::C_NFA(const T_Inputs &inputs)
 {
-    C_FinalState f;
-    delta[q0][f].m_UserInputs = inputs;
-    F.emplace_back(f);
-}
-
-template<class T_Inputs, class T_Action, class C_Traits>
-void C_NFA<T_Inputs,T_Action,C_Traits>::operator=(const C_NFA &a)
-{
-    q0      = a.q0;
-    F       = a.F;
-    delta   = a.delta;
+    const auto f = newState();
+    addInputs(q0, f, inputs);
+    F.push_back({f, {}});
 }
 
 template<class T_Inputs, class T_Action, class C_Traits>
-void C_NFA<T_Inputs,T_Action,C_Traits>::operator=(C_NFA &&a)
-{
-    q0 = a.q0;
-    F.swap(a.F);
-    delta.swap(a.delta);
-}
-
-template<class T_Inputs, class T_Action, class C_Traits>
-void C_NFA<T_Inputs,T_Action,C_Traits>::operator|=(const C_NFA &_a)
+void C_NFA<T_Inputs,T_Action,C_Traits>::operator|=(const C_NFA &a)
 {
     if (F.empty())
-        *this = _a;
+        *this = a;
     else
     {
-        std::set<C_NfaState> usedStates;
-        gatherStates(usedStates);
-        C_NFA _;
-        const C_NFA &a = _a.checkReuse(usedStates, _);
-        F.insert(F.end(), a.F.begin(), a.F.end());
-        delta.insert(a.delta.begin(), a.delta.end());
-        delta[q0][a.q0].m_Epsilon =true;
+        addEpsilon(q0, import(a));
     }
 }
 
 template<class T_Inputs, class T_Action, class C_Traits>
-C_NFA<T_Inputs,T_Action,C_Traits> &C_NFA<T_Inputs,T_Action,C_Traits>::append(const C_NFA &_a)
+C_NFA<T_Inputs,T_Action,C_Traits> &C_NFA<T_Inputs,T_Action,C_Traits>::append(const C_NFA &a)
 {
     if (F.empty())
-        *this = _a;
+        *this = a;
     else
     {
-        std::set<C_NfaState> usedStates;
-        gatherStates(usedStates);
-        C_NFA _;
-        const C_NFA &a = _a.checkReuse(usedStates, _);
-        delta.insert(a.delta.begin(), a.delta.end());
-        for (const auto &i: F)
-            delta[i][a.q0].m_Epsilon = true;
-        F = a.F;
+        const auto n = F.size();
+        const auto aq0 = import(a);
+        for (size_t i = 0; i < n; ++i)
+            addEpsilon(F[i].m_State, aq0);
+
+        F.erase(F.begin(), F.begin() + std::ptrdiff_t(n));
     }
     return *this;
 }
@@ -293,17 +404,17 @@ C_NFA<T_Inputs,T_Action,C_Traits> &C_NFA<T_Inputs,T_Action,C_Traits>::append(con
 template<class T_Inputs, class T_Action, class C_Traits>
 C_NFA<T_Inputs,T_Action,C_Traits> &C_NFA<T_Inputs,T_Action,C_Traits>::append(const T_Inputs &inputs)
 {
-    C_FinalState f;
+    const auto f = newState();
     if (F.empty())
-        delta[q0][f].m_UserInputs = inputs;
+        addInputs(q0, f, inputs);
     else
     {
         for (const auto &i: F)
-            delta[i][f].m_UserInputs = inputs;
+            addInputs(i.m_State, f, inputs);
 
         F.clear();
     }
-    F.push_back(f);
+    F.push_back({f, {}});
     return *this;
 }
 
@@ -313,64 +424,31 @@ C_NFA<T_Inputs,T_Action,C_Traits> &C_NFA<T_Inputs,T_Action,C_Traits>::changeTo(i
     for (const auto &i: F)
     {
         if (FA_REPEATABLE &options)
-            delta[i][q0].m_Epsilon = true;
+            addEpsilon(i.m_State, q0);
         if (FA_OPTIONAL &options)
-            delta[q0][i].m_Epsilon = true;
+            addEpsilon(q0, i.m_State);
     }
     return *this;
 }
 
 template<class T_Inputs, class T_Action, class C_Traits>
-const C_NFA<T_Inputs,T_Action,C_Traits> &C_NFA<T_Inputs,T_Action,C_Traits>::checkReuse(
-    const std::set<C_NfaState>  &usedStates,
-    C_NFA<T_Inputs,T_Action,C_Traits> &replacement ) const
-{
-    typedef std::map<C_NfaState,C_NfaState> C_Map;
-    C_Map map;
-    for (const auto &i: delta)
-    {
-        if (usedStates.find(i.first) != usedStates.end())
-            map[i.first];
-
-        for (const auto &j: i.second)
-            if (usedStates.find(j.first) != usedStates.end())
-                map[j.first];
-    }
-    if (map.empty())
-        // No conflict
-        return *this;
-
-    C_Map::const_iterator found = map.find(q0);
-    replacement.q0 = found != map.end()? found->second: q0;
-
-    for (const auto &i: F)
-    {
-        found = map.find(i);
-        replacement.F.emplace_back(found != map.end()? found->second: i, i.m_Tag);
-    }
-
-    for (const auto &i: delta)
-    {
-        found = map.find(i.first);
-        auto &t =replacement.delta[found != map.end()? found->second: i.first];
-        for (const auto &j: i.second)
-        {
-            found = map.find(j.first);
-            t[found != map.end()? found->second: j.first] =j.second;
-        }
-    }
-    return replacement;
-}
-
-template<class T_Inputs, class T_Action, class C_Traits>
-void C_NFA<T_Inputs,T_Action,C_Traits>::gatherStates(std::set<C_NfaState> &usedStates) const
+C_NfaState C_NFA<T_Inputs,T_Action,C_Traits>::import(const C_NFA &a)
+/*! Add states, final states & transitions of \em a renumbered after those of this NFA.
+    \return The starting state of \em a after renumbering
+*/
 {
-    for (const auto &i: delta)
-    {
-        usedStates.insert(i.first);
-        for (const auto &j: i.second)
-            usedStates.insert(j.first);
-    }
+    if (&a == this)
+        return import(C_NFA{a});
+
+    const auto off = m_TotalStates;
+    m_TotalStates += a.m_TotalStates;
+    for (const auto &i: a.F)
+        F.push_back({i.m_State + off, i.m_Tag});
+    delta.reserve(delta.size() + a.delta.size());
+    for (const auto &i: a.delta)
+        delta.push_back({i.m_From + off, i.m_To + off, i.m_UserInputs, i.m_Epsilon});
+
+    return a.q0 + off;
 }
 
 template<class T_Inputs, class T_Action, class C_Traits>
@@ -382,387 +460,549 @@ void C_NFA<T_Inputs,T_Action,C_Traits>::setAction(T &&action)
 }
 
 template<class T_Inputs, class T_Action, class C_Traits>
-void C_DFA<T_Inputs,T_Action,C_Traits>::buildA2C(
-    const C_FinalMap        &Ffat,
-    const C_DfaClosure      &closure,
-    C_Action2Closure        &a2c        )
+bool C_DFA<T_Inputs,T_Action,C_Traits>::isFinal(int state, T_Action &action) const
 {
-    for (const auto &i: Ffat)
+    if (size_t(state) < F.size() && F[size_t(state)])
     {
-        if (closure.find(i.first) != closure.end())
-            a2c[i.second].insert(i.first);
+        action = *F[size_t(state)];
+        return true;
     }
+    return false;
 }
 
 template<class T_Inputs, class T_Action, class C_Traits>
-void C_DFA<T_Inputs,T_Action,C_Traits>::createClosure(C_NfaClosure &c, const C_SourceDelta &delta)
+void C_DFA<T_Inputs,T_Action,C_Traits>::minDfa(
+    const C_Finals          &Ffat,
+    const std::vector<int>  &deltaFat,
+    size_t                  classes,
+    C_Finals                &Fmin,
+    std::vector<int>        &deltaMin       )
 {
-    C_NfaClosure test(c);
-    while (true)
+    // Hopcroft's partition refinement over integer states and input classes, O(m log n) for m transitions.
+    // The transition function being partial, every initial block has to be a splitter, not all but one
+    // (Valmari & Lehtinen 2008)
+    const auto n = Ffat.size();
+
+    struct C_InEdge
     {
-        C_NfaClosure add;
-        for (const auto &i: test)
-        {
-            const auto found = delta.find(i);
-            if (found != delta.end())
+        size_t  m_Class;
+        int     m_From;
+
+        auto operator<=>(const C_InEdge &) const = default;
+    };
+    std::vector<std::vector<C_InEdge>> inEdges(n);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t c = 0; c < classes; ++c)
+            if (const auto to = deltaFat[i * classes + c]; to >= 0)
+                inEdges[size_t(to)].push_back({c, int(i)});
+
+    // Refinable partition: elements of each block are contiguous in elems[]
+    struct C_Block
+    {
+        size_t  m_First, m_End, m_Marked;
+        bool    m_IsSplitter;
+    };
+    std::vector<C_Block> blocks;
+    std::vector<int> elems;
+    std::vector<size_t> locOf(n), blockOf(n);
+    elems.reserve(n);
+    {
+        // Initial partition: nonfinal states and then final states by action
+        std::map<T_Action,std::vector<int>> a2s;
+        std::vector<int> nonfinal;
+        for (size_t i = 0; i < n; ++i)
+            (Ffat[i]? a2s[*Ffat[i]]: nonfinal).push_back(int(i));
+
+        const auto addBlock = [&](const std::vector<int> &states) {
+            if (states.empty())
+                return;
+
+            for (auto i: states)
             {
-                for (const auto &j: found->second)
-                    if (j.second.m_Epsilon && c.find(j.first) == c.end())
-                        add.insert(j.first);
+                locOf[size_t(i)] = elems.size();
+                blockOf[size_t(i)] = blocks.size();
+                elems.push_back(i);
             }
-        }
-        if (add.empty())
-            break;
-
-        c.insert(add.begin(), add.end());
-        test.swap(add);
+            blocks.push_back({elems.size() - states.size(), elems.size(), 0, true});
+        };
+        addBlock(nonfinal);
+        for (const auto &i: a2s)
+            addBlock(i.second);
     }
-}
+    std::vector<size_t> splitters(blocks.size());
+    for (size_t i = 0; i < splitters.size(); ++i)
+        splitters[i] = i;
 
-template<class T_Inputs, class T_Action, class C_Traits>
-auto C_DFA<T_Inputs,T_Action,C_Traits>::findDfaClosure(const C_DfaClosures &Q, int state) -> typename C_DfaClosures::const_iterator
-{
-    for (auto i = Q.begin(), end = Q.end(); i != end; ++i)
+    std::vector<C_InEdge> edges;
+    std::vector<size_t> touched;
+    while (!splitters.empty())
     {
-        if (i->m_Closure.find(state) != i->m_Closure.end())
-            // Found
-            return i;
+        const auto b = splitters.back();
+        splitters.pop_back();
+        blocks[b].m_IsSplitter = false;
+
+        edges.clear();
+        for (auto i = blocks[b].m_First; i < blocks[b].m_End; ++i)
+        {
+            const auto &src = inEdges[size_t(elems[i])];
+            edges.insert(edges.end(), src.begin(), src.end());
+        }
+        std::sort(edges.begin(), edges.end());
+        for (auto i = edges.begin(); i != edges.end();)
+        {
+            // Mark states reaching block b on the same class
+            const auto c = i->m_Class;
+            for (; i != edges.end() && i->m_Class == c; ++i)
+            {
+                const auto s = size_t(i->m_From);
+                auto &x = blocks[blockOf[s]];
+                const auto pos = x.m_First + x.m_Marked++;
+                const auto other = size_t(elems[pos]);
+                std::swap(elems[pos], elems[locOf[s]]);
+                locOf[other] = locOf[s];
+                locOf[s] = pos;
+                if (x.m_Marked == 1)
+                    touched.push_back(blockOf[s]);
+            }
+            // Split touched blocks into marked and unmarked
+            for (auto x: touched)
+            {
+                auto &bx = blocks[x];
+                const auto marked = bx.m_Marked;
+                bx.m_Marked = 0;
+                if (marked == bx.m_End - bx.m_First)
+                    continue;
+
+                const auto y = blocks.size();
+                const C_Block by{bx.m_First, bx.m_First + marked, 0, false};
+                bx.m_First += marked;
+                for (auto j = by.m_First; j < by.m_End; ++j)
+                    blockOf[size_t(elems[j])] = y;
+
+                const bool xIsSplitter = bx.m_IsSplitter;
+                const bool ySmaller = marked <= bx.m_End - bx.m_First;
+                blocks.push_back(by);
+                if (xIsSplitter || ySmaller)
+                {
+                    blocks[y].m_IsSplitter = true;
+                    splitters.push_back(y);
+                }
+                else
+                {
+                    blocks[x].m_IsSplitter = true;
+                    splitters.push_back(x);
+                }
+            }
+            touched.clear();
+        }
     }
-    throw std::runtime_error{"State " + std::to_string(state) + " not found"};
-}
 
-template<class T_Inputs, class T_Action, class C_Traits>
-bool C_DFA<T_Inputs,T_Action,C_Traits>::isFinal(int state, T_Action &action) const
-{
-    const auto i =F.find(state);
-    if (i != F.end())
+    // Number the blocks by their smallest states, so that the starting state 0 stays 0
+    std::vector<std::pair<int,size_t>> order;
+    order.reserve(blocks.size());
+    for (size_t i = 0; i < blocks.size(); ++i)
+        order.emplace_back(*std::min_element(elems.begin() + std::ptrdiff_t(blocks[i].m_First),
+                                             elems.begin() + std::ptrdiff_t(blocks[i].m_End)), i);
+    std::sort(order.begin(), order.end());
+    std::vector<int> newId(blocks.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        newId[order[i].second] = int(i);
+
+    // Any state of a block represents the block
+    Fmin.assign(order.size(), std::nullopt);
+    deltaMin.assign(order.size() * classes, -1);
+    for (const auto &i: order)
     {
-        action = i->second;
-        return true;
+        const auto rep = size_t(i.first);
+        const auto id = size_t(newId[i.second]);
+        Fmin[id] = Ffat[rep];
+        for (size_t c = 0; c < classes; ++c)
+            if (const auto to = deltaFat[rep * classes + c]; to >= 0)
+                deltaMin[id * classes + c] = newId[blockOf[size_t(to)]];
     }
-    return false;
 }
 
 template<class T_Inputs, class T_Action, class C_Traits>
-void C_DFA<T_Inputs,T_Action,C_Traits>::minDfa(
-    const C_FinalMap        &Ffat,
-    const C_TransitionMap   &deltaFat,
-    int                     totalFatStates,
-    C_FinalMap              &Fmin,
-    C_TransitionMap         &deltaMin       )
+template<class F_PickAction>
+void C_DFA<T_Inputs,T_Action,C_Traits>::nfa2dfa(const C_NFA<T_Inputs,T_Action,C_Traits> &nfa,
+    std::vector<T_Inputs> &classes, C_Finals &F, std::vector<int> &delta, F_PickAction pickAction, unsigned threads)
 {
-    // Figure 7.7: Algorithm MinDFA
-    C_DfaClosures Qfat;
-    Qfat.emplace_back();
-    Qfat.emplace_back();
-    auto &part0 = Qfat.front().m_Closure;
-    auto &part1 = Qfat.back().m_Closure;
-    int tag =0;
-    for (const auto &i: Ffat)
-    {
-        part0.insert(i.first);
-        while (tag < i.first)
-            part1.insert(tag++);
-
-        ++tag;
-    }
-    while (tag < totalFatStates)
-        part1.insert(tag++);
+    // Figure 7.5 (p245): Algorithm NFA->DFA, over dense indices of NFA states and input classes,
+    // expanding the frontier of unmarked DFA states concurrently
+
+    const C_Index index{nfa};
+    classes = index.m_Classes;
+    const auto K = classes.size();
 
-    bool changed;
-    do
+    typedef typename C_Index::C_Closure C_NfaClosure;
+    std::map<C_NfaClosure,int> ids;     // DFA state of each NFA closure
+    std::vector<const C_NfaClosure*> Q; // collector of all states, numbered in order of discovery
+    Q.push_back(&ids.try_emplace(index.startingClosure(), 0).first->first);
+
+    struct C_Shift
     {
-        changed = false;
-        C_DfaClosures Qmin;
-        for (const auto &i: Qfat)
+        C_NfaClosure        m_Closure;  // Moved to ids if new
+        Helper_::C_ClassSet m_Classes;
+        int                 m_To;       // -1 if yet to be numbered
+    };
+    typedef std::vector<C_Shift> C_Shifts;
+    const auto expand = [&](const C_NfaClosure &src, typename C_Index::C_Scratch &scratch) {
+        // Read-only to everything but the arguments, to be called concurrently
+        typename C_Index::C_Moves map;
+        index.move(src, scratch, map);
+
+        C_Shifts ret;
+        ret.reserve(map.size());
+        for (auto &j: map)
         {
-            auto fat = i.m_Closure;
-            while (!fat.empty())
-            {
-                C_DfaClosure slim;
-                auto j = fat.begin();
-                slim.insert(*j);
-                typedef std::map<const C_DfaClosure*,T_Inputs> C_CmpMap;
-                C_CmpMap cmpmap;
-                auto k = deltaFat.find(*j);
-                if (k != deltaFat.end())
-                    for (const auto &m: k->second)
-                        cmpmap[&findDfaClosure(Qfat, m.first)->m_Closure] = m.second;
-
-                while (++j != fat.end())
+            auto t = j.first;
+            index.close(t, scratch);
+            const auto found = ids.find(t);
+            if (found != ids.end())
+                ret.push_back({{}, std::move(j.second), found->second});
+            else
+                ret.push_back({std::move(t), std::move(j.second), -1});
+        }
+        return ret;
+    };
+
+    if (!threads)
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    std::vector<C_Shifts> shifts;
+    delta.clear();
+    for (size_t begin = 0, end; begin < Q.size(); begin = end)
+    {
+        // Expand Q[begin, end) with ids being read only
+        end = Q.size();
+        shifts.assign(end - begin, {});
+        std::atomic<size_t> next{begin};
+        std::exception_ptr error;
+        std::mutex lockError;
+        const auto work = [&]{
+            auto scratch = index.newScratch();
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < end;)
+                try
                 {
-                    C_CmpMap map;
-                    bool deal = true;
-                    k = deltaFat.find(*j);
-                    if (k != deltaFat.end())
-                        for (const auto &m: k->second)
-                        {
-                            const auto *t = &findDfaClosure(Qfat, m.first)->m_Closure;
-                            auto found = cmpmap.find(t);
-                            if (found != cmpmap.end() &&
-                                C_Traits::equalInput(m.second, found->second))
-                            {
-                                map[t] = m.second;
-                                continue;
-                            }
-                            deal = false;
-                            break;
-                        }
-                    if (deal)
-                    {
-                        auto i_map = map.begin();
-                        for (auto &j_cmp: cmpmap)
-                        {
-                            if (i_map == map.end() ||
-                                i_map->first != j_cmp.first ||
-                                !C_Traits::equalInput(i_map->second, j_cmp.second))
-                            {
-                                deal = false;
-                                break;
-                            }
-                            ++i_map;
-                        }
-                        if (deal && i_map == map.end())
-                            slim.insert(*j);
-                    }
+                    shifts[i - begin] = expand(*Q[i], scratch);
                 }
-                Qmin.emplace_back(slim);
-                C_DfaClosure temp;
-                std::set_difference(fat.begin(), fat.end(),
-                    slim.begin(), slim.end(), std::inserter(temp, temp.begin()));
-                fat.swap(temp);
-            }
-        }
-        if (Qmin.size() == Qfat.size())
-        {
-            for (auto i =Qmin.begin(), end =Qmin.end(); i != end; ++i)
-            {
-                C_Action2Closure a2c;
-                buildA2C(Ffat, i->m_Closure, a2c);
-                if (a2c.size() > 1)
+                catch (...)
                 {
-                    // Solve conflict
-                    auto j = a2c.begin();
-                    i->m_Closure.swap(j->second); // overwrite the superset
-                    auto next = i;
-                    ++next;
-                    while (++j != a2c.end())
-                        i = Qmin.insert(next, j->second);
+                    next = end;
+                    const std::lock_guard _{lockError};
+                    if (!error)
+                        error = std::current_exception();
                 }
-            }
-        }
-        if (Qmin.size() != Qfat.size())
+        };
+        if (const auto workers = std::min<size_t>(threads, (end - begin) / MIN_STATES_PER_THREAD); workers > 1)
         {
-            Qfat.swap(Qmin);
-            changed =true;
+            std::vector<std::jthread> pool;
+            pool.reserve(workers);
+            for (size_t i = 0; i < workers; ++i)
+                pool.emplace_back(work);
         }
-    } while (changed);
+        else
+            work();
 
-    // Tagging
-    tag =0;
-    for (auto i = Qfat.begin(), end = Qfat.end(); i != end; ++i, ++tag)
-    {
-        if (tag && i->m_Closure.find(0) != i->m_Closure.end())
-            // Q0 is always tagged 0
-        {
-            i->m_Tag = 0;
-            Qfat.front().m_Tag = tag;
-            auto t = Fmin.find(0);
-            if (t != Fmin.end())
+        if (error)
+            std::rethrow_exception(error);
+
+        // Number the new states in order, as if the frontier were expanded one by one
+        delta.resize(end * K, -1);
+        for (size_t i = begin; i < end; ++i)
+            for (auto &j: shifts[i - begin])
             {
-                const auto a = t->second;
-                Fmin.erase(t);
-                Fmin[tag] = a;
-            }
-        }
-        else
-            i->m_Tag = tag;
+                if (j.m_To < 0)
+                {
+                    const auto found = ids.try_emplace(std::move(j.m_Closure), int(Q.size()));
+                    if (found.second)
+                        // new state
+                        Q.push_back(&found.first->first);
 
-        C_Action2Closure a2c;
-        buildA2C(Ffat, i->m_Closure, a2c);
-        if (!a2c.empty())
-        {
-            Fmin[i->m_Tag] = a2c.begin()->first;
-            if (a2c.size() > 1)
-                // Impossible
-                throw std::runtime_error{"a2c.size() == " + std::to_string(a2c.size())};
-        }
+                    j.m_To = found.first->second;
+                }
+                j.m_Classes.eachClass([&](size_t c) { delta[i * K + c] = j.m_To; });
+            }
     }
-    for (const auto &i: deltaFat)
+
+    F.assign(Q.size(), std::nullopt);
+    for (size_t i = 0; i < Q.size(); ++i)
     {
-        auto &dst_i = deltaMin[findDfaClosure(Qfat,i.first)->m_Tag];
-        for (const auto &j: i.second)
+        const auto conflict = index.actionsOf(*Q[i]);
+        if (!conflict.empty())
         {
-            const auto value = findDfaClosure(Qfat,j.first)->m_Tag;
-            for (const auto &dst_j: dst_i)
+            if (conflict.size() > 1)
+                // Solve conflict
             {
-                if (C_Traits::equalInput(dst_j.second, j.second))
-                {
-                    if (dst_j.first == value)
-                        // Aleady added
-                        goto PostInsertion;
+                auto action = pickAction(int(i), conflict);
+                if (action == T_Action())
+                    throw std::runtime_error{"Interrupted"};
 
-                    throw std::runtime_error{"Contradicted mapping"};
-                }
+                F[i] = action;
             }
-            C_Traits::inputUnion(dst_i[value], j.second);
-        PostInsertion:;
+            else
+                F[i] = *conflict.begin();
         }
     }
 }
 
 template<class T_Inputs, class T_Action, class C_Traits>
-template<class F_PickAction>
-int C_DFA<T_Inputs,T_Action,C_Traits>::nfa2dfa(const C_NFA<T_Inputs,T_Action,C_Traits> &nfa,
-    C_FinalMap &F, C_TransitionMap &delta, F_PickAction pickAction)
+C_LazyDFA<T_Inputs,T_Action,C_Traits>::C_LazyDFA(const C_NFA<T_Inputs,T_Action,C_Traits> &nfa,
+    F_PickAction pickAction, size_t maxBytes):
+    m_Index(nfa),
+    m_PickAction(std::move(pickAction)),
+    m_Start(m_Index.startingClosure()),
+    m_Scratch(m_Index.newScratch()),
+    m_MaxBytes(maxBytes)
+/*! \param [in] nfa Source NFA
+    \param [in] pickAction Called as <tt>pickAction(state, conflict)</tt> to pick one of the conflicting
+                actions when the state is made; returning <tt>T_Action()</tt> throws std::runtime_error.
+                It can be called again on the same conflict after a flush.
+    \param [in] maxBytes Rough memory budget of cached states
+*/
+{
+    addState(C_Closure{m_Start});
+}
+
+template<class T_Inputs, class T_Action, class C_Traits>
+int C_LazyDFA<T_Inputs,T_Action,C_Traits>::addState(C_Closure &&c)
 {
-    // Figure 7.5 (p245): Algorithm NFA->DFA
-    std::list<C_TaggedNfaClosure> Q;    // collector of all states
-    Q.emplace_back(C_NfaClosure{});
-    auto *const q0 = &Q.front().m_Closure; // starting point index of Q
-    q0->insert(nfa.q0);
-    createClosure(*q0, nfa.delta);
-
-    typedef std::pair<T_Inputs, const C_TaggedNfaClosure*> C_InputClosurePair;
-    typedef std::vector<C_InputClosurePair> C_Input2Closure;
-    std::map<const C_TaggedNfaClosure*, C_Input2Closure,
-            bool (*)(const C_TaggedNfaClosure*,const C_TaggedNfaClosure*)>
-            deltaNfa([](const C_TaggedNfaClosure *a, const C_TaggedNfaClosure *b)->bool {
-                return a->m_Closure < b->m_Closure;
-            });  // transition relation
-    bool    changed;
-    do
-    {
-        changed =false;
-        for (auto &q: Q)
+    // Resolve the action before publishing the id, so that nothing is left behind if it throws
+    const auto id = int(m_States.size());
+    std::optional<T_Action> action;
+    if (const auto conflict = m_Index.actionsOf(c); !conflict.empty())
+    {
+        if (conflict.size() > 1)
+            // Solve conflict
         {
-            if (q.m_Tag)
-                continue;
+            auto picked = m_PickAction(id, conflict);
+            if (picked == T_Action())
+                throw std::runtime_error{"Interrupted"};
 
-            typedef std::map<C_NfaClosure,T_Inputs> C_ShiftMap;
-            C_ShiftMap map;
-            q.m_Tag = true;
-            for (const auto &j: q.m_Closure)
-            {
-                auto found = nfa.delta.find(j);
-                if (found != nfa.delta.end())
-                    for (const auto &k: found->second)
-                    {
-                        if (!C_Traits::isEmptyInput(k.second.m_UserInputs))
-                        {
-                            C_NfaClosure key;
-                            key.insert(k.first);
-                            C_Traits::inputUnion(map[key], k.second.m_UserInputs);
-                        }
-                    }
-            }
-            // Here map is already created with keys of state singletons and values without epsilon
-            C_ShiftMap partitionedMap;
-        MergeAgain:
-            switch (map.size())
-            {
-            case 1:
-                partitionedMap.insert(*map.begin());
-                break;
-            case 0:
-                break;
-            default: // > 1
-                for (auto i = map.begin(), end = map.end(); i != end; ++i)
-                    for (auto j = i; ++j != end;)
-                    {
-                        // Emptyness of (i - j)
-                        T_Inputs insetsect(i->second);
-                        C_Traits::inputIntersection(insetsect, j->second);
-                        if (C_Traits::isEmptyInput(insetsect))
-                            continue;
-
-                        if (map.begin() != i)
-                            // Move away the disjointed part first
-                        {
-                            partitionedMap.insert(map.begin(), i);
-                            map.erase(map.begin(), i);
-                        }
-                        C_NfaClosure key(i->first);
-                        key.insert(j->first.begin(), j->first.end());
-
-                        T_Inputs t(i->second);
-                        C_Traits::inputDifference(t, insetsect);
-                        if (C_Traits::isEmptyInput(t))
-                            map.erase(i);
-                        else
-                            i->second = t;
-
-                        t = j->second;
-                        C_Traits::inputDifference(t, insetsect);
-                        if (C_Traits::isEmptyInput(t))
-                            map.erase(j);
-                        else
-                            j->second = t;
-
-                        map[key] =insetsect;
-                        goto MergeAgain;
-                    }
-                partitionedMap.insert(map.begin(), map.end());
-            } // switch (map.size())
-            map.swap(partitionedMap);
-            /* Here map is with
-             *  keys union of which equals to union of original keys
-             * and
-             *  values which together partition the union of all original values except episilon.
-             */
-            for (const auto &j: map)
-            {
-                C_TaggedNfaClosure t(j.first);
-                createClosure(t.m_Closure, nfa.delta);
-                const C_TaggedNfaClosure *next;
-                for (const auto &k: Q)
-                    if (t.m_Closure == k.m_Closure)
-                    {
-                        next = &k;
-                        goto postAddClosure;
-                    }
-                Q.emplace_back(t); // new state t
-                next = &Q.back();
-            postAddClosure:
-                deltaNfa[&q].emplace_back(j.second, next);
-                changed =true;
-            }
+            action = picked;
         }
-    } while (changed);
+        else
+            action = *conflict.begin();
+    }
+    m_States.reserve(m_States.size() + 1);
+    m_Next.resize((size_t(id) + 1) * totalClasses(), UNKNOWN);
+    const auto found = m_Ids.try_emplace(std::move(c), id);
+    m_States.push_back({&found.first->first, action}); // Reserved not to throw
+    m_Bytes += bytesOf(found.first->first);
+    return id;
+}
+
+template<class T_Inputs, class T_Action, class C_Traits>
+void C_LazyDFA<T_Inputs,T_Action,C_Traits>::flush()
+{
+    m_Ids.clear();
+    m_States.clear();
+    m_Next.clear();
+    m_Bytes = 0;
+    ++m_Flushes;
+    addState(C_Closure{m_Start});
+}
+
+template<class T_Inputs, class T_Action, class C_Traits>
+bool C_LazyDFA<T_Inputs,T_Action,C_Traits>::isFinal(int state, T_Action &action) const
+{
+    if (const auto &a = m_States[size_t(state)].m_Action)
+    {
+        action = *a;
+        return true;
+    }
+    return false;
+}
+
+template<class T_Inputs, class T_Action, class C_Traits>
+int C_LazyDFA<T_Inputs,T_Action,C_Traits>::nextState(int state, size_t inputClass)
+/*! \return The next state, or -1 if \em state doesn't move on inputs of \em inputClass
+
+    States unknown yet are made on the way. If that flushes the cache, only the starting state and the
+    returned state stay valid.
+*/
+{
+    const auto K = totalClasses();
+    if (const auto next = m_Next[size_t(state) * K + inputClass]; next != UNKNOWN)
+        return next;
+
+    // Make the whole row at once
+    m_Moves.clear();
+    m_Index.move(*m_States[size_t(state)].m_Closure, m_Scratch, m_Moves);
+    std::vector<std::pair<C_Closure,const Helper_::C_ClassSet*>> targets;
+    targets.reserve(m_Moves.size());
+    size_t bytes = 0;
+    for (const auto &i: m_Moves)
+    {
+        auto t = i.first;
+        m_Index.close(t, m_Scratch);
+        if (!m_Ids.contains(t))
+            bytes += bytesOf(t);
 
-    int tag = 0;
-    for (auto &i: Q)
+        targets.emplace_back(std::move(t), &i.second);
+    }
+    if (m_Bytes + bytes > m_MaxBytes && m_States.size() > 1)
     {
-        i.m_Tag = tag++;
-        C_Conflict conflict;
-        for (const auto &j: nfa.F)
+        auto src = *m_States[size_t(state)].m_Closure;
+        flush();
+        state = src == m_Start? 0: addState(std::move(src));
+    }
+
+    // Fill the row only after all targets are made, so that it stays unknown if addState() throws
+    std::vector<int> to(targets.size());
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        const auto found = m_Ids.find(targets[i].first);
+        to[i] = found != m_Ids.end()? found->second: addState(std::move(targets[i].first));
+    }
+    const auto row = size_t(state) * K;
+    std::fill_n(m_Next.begin() + std::ptrdiff_t(row), K, -1);
+    for (size_t i = 0; i < targets.size(); ++i)
+        targets[i].second->eachClass([&](size_t c) { m_Next[row + c] = to[i]; });
+
+    return m_Next[row + inputClass];
+}
+
+template<class T_Inputs, class T_Action, class C_Traits>
+Helper_::C_NfaIndex<T_Inputs,T_Action,C_Traits>::C_NfaIndex(const C_NFA<T_Inputs,T_Action,C_Traits> &nfa)
+{
+    // Split inputs into disjoint classes so that each transition is on a set of classes
+    for (const auto &i: nfa.delta)
+        if (!C_Traits::isEmptyInput(i.m_UserInputs))
+            refineClasses(m_Classes, i.m_UserInputs);
+
+    const auto K = m_Classes.size();
+    const auto classesOf = [&](const T_Inputs &inputs) {
+        C_ClassSet ret(K);
+        for (size_t c = 0; c < K; ++c)
         {
-            if (i.m_Closure.find(j) != i.m_Closure.end())
-                conflict.insert(j.m_Tag);
+            T_Inputs t(m_Classes[c]);
+            C_Traits::inputIntersection(t, inputs);
+            if (!C_Traits::isEmptyInput(t))
+                ret.set(c);
         }
-        if (!conflict.empty())
-        {
-            if (conflict.size() > 1)
-                // Solve conflict
-            {
-                auto action = pickAction(i.m_Tag, conflict);
-                if (action == T_Action())
-                    throw std::runtime_error{"Interrupted"};
+        return ret;
+    };
+
+    // Epsilon and non-epsilon transitions as compressed sparse rows
+    const size_t n = nfa.m_TotalStates;
+    m_EpsStart.resize(n + 1);
+    m_MoveStart.resize(n + 1);
+    for (const auto &i: nfa.delta)
+    {
+        if (i.m_Epsilon)
+            ++m_EpsStart[i.m_From + 1];
+        if (!C_Traits::isEmptyInput(i.m_UserInputs))
+            ++m_MoveStart[i.m_From + 1];
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        m_EpsStart[i + 1] += m_EpsStart[i];
+        m_MoveStart[i + 1] += m_MoveStart[i];
+    }
+    m_EpsTo.resize(m_EpsStart.back());
+    m_Moves.resize(m_MoveStart.back());
+    auto epsPos = m_EpsStart, movePos = m_MoveStart;
+    for (const auto &i: nfa.delta)
+    {
+        if (i.m_Epsilon)
+            m_EpsTo[epsPos[i.m_From]++] = i.m_To;
+        if (!C_Traits::isEmptyInput(i.m_UserInputs))
+            m_Moves[movePos[i.m_From]++] = {i.m_To, classesOf(i.m_UserInputs)};
+    }
+
+    // Actions of final NFA states
+    m_Finals.reserve(nfa.F.size());
+    for (const auto &i: nfa.F)
+        m_Finals.emplace_back(i.m_State, i.m_Tag);
+    std::stable_sort(m_Finals.begin(), m_Finals.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+}
+
+template<class T_Inputs, class T_Action, class C_Traits>
+std::set<T_Action> Helper_::C_NfaIndex<T_Inputs,T_Action,C_Traits>::actionsOf(const C_Closure &c) const
+{
+    std::set<T_Action> ret;
+    for (auto i: c)
+    {
+        auto j = std::lower_bound(m_Finals.begin(), m_Finals.end(), i, [](const auto &a, C_NfaState b) { return a.first < b; });
+        for (; j != m_Finals.end() && j->first == i; ++j)
+            ret.insert(j->second);
+    }
+    return ret;
+}
 
-                F[i.m_Tag] = action;
+template<class T_Inputs, class T_Action, class C_Traits>
+void Helper_::C_NfaIndex<T_Inputs,T_Action,C_Traits>::close(C_Closure &c, C_Scratch &scratch) const
+{
+    auto &visited = scratch.m_Visited;
+    for (auto i: c)
+        visited[i] = true;
+    for (size_t i = 0; i < c.size(); ++i)
+        for (auto j = m_EpsStart[c[i]]; j < m_EpsStart[c[i] + 1]; ++j)
+            if (const auto t = m_EpsTo[j]; !visited[t])
+            {
+                visited[t] = true;
+                c.push_back(t);
             }
-            else
-                F[i.m_Tag] = *conflict.begin();
-        }
+    for (auto i: c)
+        visited[i] = false;
+    std::sort(c.begin(), c.end());
+}
+
+template<class T_Inputs, class T_Action, class C_Traits>
+void Helper_::C_NfaIndex<T_Inputs,T_Action,C_Traits>::move(const C_Closure &src, C_Scratch &scratch, C_Moves &dst) const
+{
+    for (auto j: src)
+        for (auto k = m_MoveStart[j]; k < m_MoveStart[j + 1]; ++k)
+            m_Moves[k].m_Classes.eachClass([&](size_t c) {
+                auto &t = scratch.m_Targets[c];
+                if (t.empty())
+                    scratch.m_Touched.push_back(c);
+
+                t.push_back(m_Moves[k].m_To);
+            });
+
+    // Group classes by the NFA states they move to
+    for (auto c: scratch.m_Touched)
+    {
+        auto &t = scratch.m_Targets[c];
+        std::sort(t.begin(), t.end());
+        t.erase(std::unique(t.begin(), t.end()), t.end());
+        dst.try_emplace(t, m_Classes.size()).first->second.set(c);
+        t.clear();
     }
+    scratch.m_Touched.clear();
+}
 
-    for (const auto &i: deltaNfa)
+template<class T_Inputs, class T_Action, class C_Traits>
+void Helper_::C_NfaIndex<T_Inputs,T_Action,C_Traits>::refineClasses(std::vector<T_Inputs> &classes, const T_Inputs &inputs)
+{
+    T_Inputs rest(inputs);
+    for (size_t i = 0, n = classes.size(); i < n && !C_Traits::isEmptyInput(rest); ++i)
     {
-        auto &dstMap = delta[i.first->m_Tag];
-        for (const auto &j: i.second)
-            C_Traits::inputUnion(dstMap[j.second->m_Tag], j.first);
+        T_Inputs common(classes[i]);
+        C_Traits::inputIntersection(common, rest);
+        if (C_Traits::isEmptyInput(common))
+            continue;
+
+        C_Traits::inputDifference(rest, common);
+        C_Traits::inputDifference(classes[i], common);
+        if (C_Traits::isEmptyInput(classes[i]))
+            // Wholly covered
+            classes[i] = common;
+        else
+            classes.push_back(common);
     }
-    return tag;
+    if (!C_Traits::isEmptyInput(rest))
+        classes.push_back(rest);
+}
+
+template<class T_Inputs, class T_Action, class C_Traits>
+auto Helper_::C_NfaIndex<T_Inputs,T_Action,C_Traits>::startingClosure() const -> C_Closure
+{
+    C_Closure ret{C_NFA<T_Inputs,T_Action,C_Traits>::q0};
+    auto scratch = newScratch();
+    close(ret, scratch);
+    return ret;
 }
 
 } // namespace bux
@@ -2,29 +2,115 @@
 #ifdef _WIN32
 #include <windows.h>
 #endif
-#include <filesystem>
+#include <cstddef>      // std::byte
+#include <cstdint>      // std::uint64_t
+#include <filesystem>   // std::filesystem::path
+#include <span>         // std::span<>
+#include <string_view>  // std::string_view
 
 namespace bux {
 
+//
+//      Types
+//
+enum E_MemAdvice
+{
+    MA_NORMAL,      ///< No special treatment
+    MA_SEQUENTIAL,  ///< Expect pages to be read in order; read ahead aggressively
+    MA_RANDOM,      ///< Expect pages to be read at random; read ahead as little as possible
+    MA_WILLNEED,    ///< Expect pages to be read soon; prefetch them now
+    MA_DONTNEED,    ///< Pages are not expected to be read soon
+    MA_HUGEPAGE     ///< Back the mapping with huge pages where the kernel supports it
+};
+
 class C_FileAsMemory
+/*! Read-only memory-mapped view of a whole file or of a byte range in it.
+    Move-only; the mapping is released on destruction.
+*/
 {
 public:
 
+    // Constants
+    static constexpr size_t npos = size_t(-1);
+
     // Nonvirtuals
-    C_FileAsMemory(const std::filesystem::path& path);
+    explicit C_FileAsMemory(const std::filesystem::path& path, E_MemAdvice advice = MA_NORMAL);
+    C_FileAsMemory(const std::filesystem::path& path, std::uint64_t offset, size_t bytes, E_MemAdvice advice = MA_NORMAL);
+    C_FileAsMemory(C_FileAsMemory &&other) noexcept;
+    C_FileAsMemory &operator=(C_FileAsMemory &&other) noexcept;
+    C_FileAsMemory(const C_FileAsMemory&) = delete;
+    C_FileAsMemory &operator=(const C_FileAsMemory&) = delete;
     ~C_FileAsMemory();
-    const char* data() const { return m_data; }
+    bool advise(E_MemAdvice advice, size_t off = 0, size_t bytes = npos) const noexcept;
+    auto bytes() const noexcept     { return std::span<const std::byte>{reinterpret_cast<const std::byte*>(m_data), m_bytes}; }
+    const char* data() const noexcept { return m_data; }
+    bool empty() const noexcept     { return !m_bytes; }
+    auto offset() const noexcept    { return m_offset; }
+    auto size() const noexcept      { return m_bytes; }
+    auto span() const noexcept      { return std::span<const char>{m_data, m_bytes}; }
+    auto view() const noexcept      { return std::string_view{m_data, m_bytes}; }
+    static size_t granularity() noexcept;
+        ///< Alignment the mapped start is rounded down to; any offset is still accepted.
+
+private:
+
+    // Data
+    char*           m_base{};       ///< Start of the mapped pages
+    size_t          m_mapBytes{};   ///< Size of the mapped pages
+    const char*     m_data{};       ///< m_base + (m_offset % granularity())
+    size_t          m_bytes{};
+    std::uint64_t   m_offset{};
+
+    // Nonvirtuals
+    void map(const std::filesystem::path& path, std::uint64_t offset, size_t bytes);
+    void unmap() noexcept;
+};
+
+class C_OFileAsMemory
+/*! Write-only memory-mapped file which grows its mapping geometrically as
+    data is appended, and is truncated to the exact size written on finalize().
+    Move-only.
+*/
+{
+public:
+
+    // Nonvirtuals
+    explicit C_OFileAsMemory(const std::filesystem::path& path, size_t reserve = 0);
+    C_OFileAsMemory(C_OFileAsMemory &&other) noexcept;
+    C_OFileAsMemory &operator=(C_OFileAsMemory &&other);
+        ///< Finalize the current file before taking over \em other
+    C_OFileAsMemory(const C_OFileAsMemory&) = delete;
+    C_OFileAsMemory &operator=(const C_OFileAsMemory&) = delete;
+    ~C_OFileAsMemory();
+    void append(const char *src, size_t bytes);
+        ///< Same signature as std::string::append() so that functions of Serialize.h can write into it.
+    auto capacity() const noexcept  { return m_capacity; }
+    void commit(size_t bytes);
+        ///< Claim \em bytes written into spare() as appended.
+    char *data() const noexcept     { return m_data; }
+    void finalize();
+        ///< Unmap and truncate the file to size(). Implied by dtor, which swallows errors.
+    void reserve(size_t bytes);
+        ///< Make room for at least \em bytes in total.
+    auto size() const noexcept      { return m_size; }
+    std::span<char> spare(size_t minBytes = 1);
+        ///< Return writable space beyond size() of at least \em minBytes, e.g. as buffer of C_OMemStream
 
 private:
 
     // Data
-    char*       m_data{};
+    char            *m_data{};
+    size_t          m_size{};
+    size_t          m_capacity{};
 #ifdef _WIN32
-    HANDLE      m_handle{};
+    HANDLE          m_file{INVALID_HANDLE_VALUE};
+    HANDLE          m_mapping{};
 #else
-    size_t      m_bytes{};
-    int         m_fd = -1;
+    int             m_fd = -1;
 #endif
+
+    // Nonvirtuals
+    void remap(size_t capacity);
 };
 
 } // namespace bux
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "ParserBase.h" // bux::T_StateID, bux::F_GetProducedT<>, LexBase.h
+#include "ParserBase.h" // bux::T_StateID, bux::F_GetProducedT<>, bux::F_GetProducedRefT<>, LexBase.h
 #include <memory>       // std::shared_ptr<>
 #include <optional>     // std::optional<>
 #include <vector>       // std::vector<>
@@ -25,10 +25,11 @@ typedef unsigned T_ActionId;
 typedef std::shared_ptr<const I_LexAttr> C_LexPtr;
 typedef C_LexInfoT<const I_LexAttr,std::shared_ptr> C_LexInfo;
 typedef F_GetProducedT<const I_LexAttr,std::shared_ptr> F_GetProduced;
+typedef F_GetProducedRefT<const I_LexAttr,std::shared_ptr> F_GetProducedRef;
 
 class C_Parser;
 typedef std::function<void(C_Parser &parser)> F_OncePostShift;
-typedef std::function<void(C_Parser&, const F_GetProduced&, C_LexPtr&, F_OncePostShift&)> FH_Reduce;
+typedef std::function<void(C_Parser&, const F_GetProducedRef&, C_LexPtr&, F_OncePostShift&)> FH_Reduce;
 
 class C_Parser;
 
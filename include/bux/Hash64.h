@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>      // std::byte
+#include <cstdint>      // std::uint64_t
+#include <span>         // std::span<>
+#include <string_view>  // std::string_view
+
+namespace bux {
+
+//
+//      Types
+//
+class C_Hash64
+/*! Streaming XXH64 -- fast, non-cryptographic and stable across platforms, compilers & library versions,
+    unlike std::hash<>, so that it is fit to be persisted along with the hashed data.
+
+    Feeding the same bytes in whatever pieces to update() gives the same digest() as hash64().
+*/
+{
+public:
+
+    // Nonvirtuals
+    explicit C_Hash64(std::uint64_t seed = 0) noexcept { reset(seed); }
+    std::uint64_t digest() const noexcept;
+        ///< Hash of all bytes so far; more may still be fed afterwards.
+    void reset(std::uint64_t seed = 0) noexcept;
+    void update(const void *data, size_t bytes) noexcept;
+    void update(std::string_view s) noexcept               { update(s.data(), s.size()); }
+    void update(std::span<const std::byte> s) noexcept     { update(s.data(), s.size()); }
+
+private:
+
+    // Data
+    std::uint64_t   m_acc[4];
+    std::uint64_t   m_seed;
+    std::uint64_t   m_total;
+    unsigned char   m_stripe[32];   ///< Pending bytes not yet making a full stripe
+    size_t          m_pending;
+};
+
+//
+//      Functions
+//
+std::uint64_t hash64(const void *data, size_t bytes, std::uint64_t seed = 0) noexcept;
+inline std::uint64_t hash64(std::string_view s, std::uint64_t seed = 0) noexcept { return hash64(s.data(), s.size(), seed); }
+
+} // namespace bux
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>    // std::inplace_merge(), std::is_sorted(), std::max(), std::min(), std::sort(), std::upper_bound()
 #include <concepts>     // std::integral<>
 #include <iterator>     // std::input_iterator<>
 #include <limits>       // std::numeric_limits<>
 #include <ostream>      // std::basic_ostream<>
-#include <stdexcept>    // std::runtime_error
+#include <span>         // std::span<>
+#include <stdexcept>    // std::runtime_error, std::invalid_argument
+#include <string>       // std::to_string()
 #include <utility>      // std::cmp_less_equal()
 #include <vector>       // std::vector<>
 
@@ -18,6 +21,8 @@ concept IntervalPt = std::integral<T> && !std::same_as<char,T>;
 
 template<IntervalPt T>
 class C_Intervals
+/*! Set of values of \em T as sorted, disjoint and nonadjacent closed intervals
+*/
 {
 public:
 
@@ -36,7 +41,11 @@ public:
     C_Intervals(I start, I end) requires std::same_as<char, std::remove_cvref_t<decltype(*start)>>
     {
         while (start != end)
-            operator|=(T(*start++)); // The cast can be an undefined behavior but I don't care for now.
+        {
+            const T t(*start++); // The cast can be an undefined behavior but I don't care for now.
+            m_Intervals.emplace_back(t, t);
+        }
+        normalize();
     }
     template<std::input_iterator I>
     C_Intervals(I start, I end) requires
@@ -47,9 +56,26 @@ public:
             std::cmp_less_equal(std::numeric_limits<T>::min(), std::numeric_limits<std::remove_cvref_t<decltype(*start)>>::min()) &&
             std::cmp_less_equal(std::numeric_limits<std::remove_cvref_t<decltype(*start)>>::max(), std::numeric_limits<T>::max())
         )
+    /*! Sort and coalesce all values or intervals in one pass, instead of merging them one by one
+    */
     {
         while (start != end)
-            operator|=(*start++);
+        {
+            if constexpr (std::same_as<value_type, std::remove_cvref_t<decltype(*start)>>)
+            {
+                const value_type i = *start++;
+                if (i.first > i.second)
+                    throw std::runtime_error{'('+std::to_string(i.first)+','+std::to_string(i.second)};
+
+                m_Intervals.emplace_back(i);
+            }
+            else
+            {
+                const T t(*start++);
+                m_Intervals.emplace_back(t, t);
+            }
+        }
+        normalize();
     }
 
     // Nonvirtuals - Assignments
@@ -62,6 +88,10 @@ public:
 
     // Nonvirtuals - Immutables
     const_iterator begin() const    { return m_Intervals.begin(); }
+    bool contains(T t) const;
+        ///< Binary search in O(log size())
+    void contains(std::span<const T> points, std::span<bool> dst) const;
+        ///< Test each of \em points into \em dst of the same size
     const_iterator end() const      { return m_Intervals.end(); }
     bool empty() const              { return m_Intervals.empty(); }
     size_t size() const             { return m_Intervals.size(); }
@@ -74,6 +104,13 @@ private:
 
     // Data
     std::vector<value_type> m_Intervals;
+
+    // Nonvirtuals
+    void coalesce(typename std::vector<value_type>::iterator from);
+    void normalize();
+
+    // Class Constants
+    static constexpr size_t BATCH_LANES = 8;
 };
 
 //
@@ -115,86 +152,44 @@ C_Intervals<T>::C_Intervals(value_type i)
 
 template<IntervalPt T>
 void C_Intervals<T>::operator|=(const C_Intervals<T> &other)
+/*! Append \em other and merge the two sorted runs in place
+*/
 {
-    decltype(m_Intervals) dst;
-    const_iterator
-         ia =other.m_Intervals.begin(), ea =other.m_Intervals.end(),
-         ib =m_Intervals.begin(), eb =m_Intervals.end();
-
-    value_type temp;
-    bool tempInUse =false;
-    while (ia != ea && ib != eb)
-    {
-        if (ia->first > ib->first)
-        {
-            std::swap(ia, ib);
-            std::swap(ea, eb);
-        }
-        // ia->first <= ib->first for sure
-        if (ia->second >= ib->second)
-            // (*ib) devoured
-            ++ib;
-        else if (ia->second < ib->first && ia->second +1 < ib->first)
-            // (*ia) and (*ib) disjointed
-        {
-            if (!tempInUse)
-                dst.emplace_back(*ia);
-            else
-                // Pending is over
-            {
-                if (temp.second +1 >= ia->first)
-                {
-                    temp.second = ia->second;
-                    dst.emplace_back(temp);
-                }
-                else
-                {
-                    dst.emplace_back(temp);
-                    dst.emplace_back(*ia);
-                }
-                tempInUse =false;
-            }
-            ++ia;
-        }
-        else
-            // Pending interval
-        {
-            if (!tempInUse)
-            {
-                temp.first = ia->first;
-                tempInUse =true;
-            }
-            temp.second = ib->second;
-            ++ia;
-            ++ib;
-        }
-    }
+    if (other.m_Intervals.empty())
+        return;
 
-    if (ib != eb)
+    if (m_Intervals.empty())
     {
-        ia =ib;
-        ea =eb;
+        m_Intervals = other.m_Intervals;
+        return;
     }
-    if (tempInUse)
+    const auto oldSize = m_Intervals.size();
+    m_Intervals.insert(m_Intervals.end(), other.m_Intervals.begin(), other.m_Intervals.end());
+    const auto mid = m_Intervals.begin() + std::ptrdiff_t(oldSize);
+    if (mid->first <= mid[-1].first)
+        std::inplace_merge(m_Intervals.begin(), mid, m_Intervals.end());
+    else
+        // Only the seam may need coalescing
     {
-        while (ia != ea)
-        {
-            if (temp.second < ia->first && temp.second +1 < ia->first)
-                break;
-
-            temp.second = ia->second;
-            ++ia;
-        }
-        dst.emplace_back(temp);
+        coalesce(mid - 1);
+        return;
     }
-    dst.insert(dst.end(), ia, ea);
-    dst.swap(m_Intervals);
+    coalesce(m_Intervals.begin());
 }
 
 template<IntervalPt T>
 void C_Intervals<T>::operator&=(const C_Intervals<T> &other)
 {
+    if (other.m_Intervals.empty() ||
+        m_Intervals.empty() ||
+        other.m_Intervals.back().second < m_Intervals.front().first ||
+        m_Intervals.back().second < other.m_Intervals.front().first)
+    {
+        m_Intervals.clear();
+        return;
+    }
     decltype(m_Intervals) dst;
+    dst.reserve(m_Intervals.size() + other.m_Intervals.size());
     const_iterator ia = other.m_Intervals.begin();
     const_iterator ea =other.m_Intervals.end();
     const_iterator ib =m_Intervals.begin();
@@ -226,50 +221,59 @@ void C_Intervals<T>::operator&=(const C_Intervals<T> &other)
 
 template<IntervalPt T>
 void C_Intervals<T>::operator-=(const C_Intervals<T> &other)
+/*! Linear merge of both, skipping subtrahends before this set by binary search
+*/
 {
-    auto ib =other.m_Intervals.begin(),
-         eb =other.m_Intervals.end();
+    if (other.m_Intervals.empty() ||
+        m_Intervals.empty() ||
+        other.m_Intervals.back().second < m_Intervals.front().first ||
+        m_Intervals.back().second < other.m_Intervals.front().first)
+        // Disjointed
+        return;
 
-    for (auto ia =m_Intervals.begin(); ia != m_Intervals.end() && ib != eb;)
+    auto ib = std::upper_bound(other.m_Intervals.begin(), other.m_Intervals.end(), m_Intervals.front().first,
+                [](T t, const value_type &i) { return t <= i.second; });
+    const auto eb = other.m_Intervals.end();
+    decltype(m_Intervals) dst;
+    dst.reserve(m_Intervals.size() + other.m_Intervals.size());
+    for (auto a: m_Intervals)
     {
-        if (ib->second < ia->first)
-        {
+        while (ib != eb && ib->second < a.first)
             ++ib;
-            continue;
-        }
 
-        // ib->first <= ib->second
-        // ia->first <= ib->second
-        // ia->first <= ia->second
-        if (ib->first <= ia->first)
+        bool devoured = false;
+        for (; ib != eb && ib->first <= a.second; ++ib)
         {
-            if (ia->second <= ib->second)
-                // (*ia) devoured by (*ib)
-                ia = m_Intervals.erase(ia);
-            else
-                // LB of (*ia) is increased
+            if (ib->first > a.first)
+                dst.emplace_back(a.first, T(ib->first - 1));
+            if (ib->second >= a.second)
+                // (*ib) may overlap the next interval, too
             {
-                ia->first = ib->second +1;
-                ++ib;
+                devoured = true;
+                break;
             }
+            a.first = T(ib->second + 1);
         }
-        else // ib->first > ia->first
-        {
-            if (ia->second <= ib->second)
-            {
-                if (ia->second >= ib->first)
-                    ia->second = ib->first -1;
+        if (!devoured)
+            dst.emplace_back(a);
+    }
+    dst.swap(m_Intervals);
+}
 
-                ++ia;
-            }
-            else // ia->second > ib->second
-            {
-                ia = m_Intervals.insert(ia, value_type(ia->first, ib->first-1));
-                (++ia)->first = ib->second +1;
-                ++ib;
-            }
-        }
-    } // for (auto ia =m_Intervals.begin(); ia != m_Intervals.end() && ib != eb;)
+template<IntervalPt T>
+void C_Intervals<T>::coalesce(typename std::vector<value_type>::iterator from)
+/*! Coalesce overlapping or adjacent intervals from \em from on, which are sorted by the first
+*/
+{
+    auto dst = from;
+    for (auto i = from; ++i != m_Intervals.end();)
+        if (i->first <= dst->second || i->first - 1 == dst->second)
+            // Overlapping or adjacent
+            dst->second = std::max(dst->second, i->second);
+        else
+            *++dst = *i;
+
+    m_Intervals.erase(++dst, m_Intervals.end());
 }
 
 template<IntervalPt T>
@@ -300,4 +304,67 @@ void C_Intervals<T>::complement()
     dst.swap(m_Intervals);
 }
 
+template<IntervalPt T>
+bool C_Intervals<T>::contains(T t) const
+{
+    const auto found = std::upper_bound(m_Intervals.begin(), m_Intervals.end(), t,
+                        [](T t_, const value_type &i) { return t_ < i.first; });
+    return found != m_Intervals.begin() && t <= found[-1].second;
+}
+
+template<IntervalPt T>
+void C_Intervals<T>::contains(std::span<const T> points, std::span<bool> dst) const
+/*! Sorted \em points are tested in one merging pass. Otherwise they are searched #BATCH_LANES at a
+    time with branch-free binary searches stepping in lockstep, so that the loads of all lanes
+    overlap and the compiler is free to vectorize them.
+*/
+{
+    if (points.size() != dst.size())
+        throw std::invalid_argument{"Points and results differ in size: "+std::to_string(points.size())+" vs "+std::to_string(dst.size())};
+
+    const auto n = m_Intervals.size();
+    if (!n)
+    {
+        std::fill(dst.begin(), dst.end(), false);
+        return;
+    }
+    if (std::is_sorted(points.begin(), points.end()))
+    {
+        auto iv = m_Intervals.begin();
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            const auto t = points[i];
+            while (iv != m_Intervals.end() && iv->second < t)
+                ++iv;
+            dst[i] = iv != m_Intervals.end() && iv->first <= t;
+        }
+        return;
+    }
+    const auto base = m_Intervals.data();
+    size_t i = 0;
+    for (; i + BATCH_LANES <= points.size(); i += BATCH_LANES)
+    {
+        size_t at[BATCH_LANES]{};   // Index of the last interval not after the point, or 0
+        for (auto len = n; len > 1; len -= len / 2)
+            for (size_t j = 0; j < BATCH_LANES; ++j)
+                at[j] += base[at[j] + len / 2].first <= points[i + j]? len / 2: 0;
+        for (size_t j = 0; j < BATCH_LANES; ++j)
+            dst[i + j] = base[at[j]].first <= points[i + j] && points[i + j] <= base[at[j]].second;
+    }
+    for (; i < points.size(); ++i)
+        dst[i] = contains(points[i]);
+}
+
+template<IntervalPt T>
+void C_Intervals<T>::normalize()
+/*! Sort and coalesce intervals of any order
+*/
+{
+    if (!m_Intervals.empty())
+    {
+        std::sort(m_Intervals.begin(), m_Intervals.end());
+        coalesce(m_Intervals.begin());
+    }
+}
+
 } // namespace bux
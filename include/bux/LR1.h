@@ -1,9 +1,14 @@
 #pragma once
 
-#include "ParserBase.h" // bux::T_StateID, bux::F_GetProducedT<>, LexBase.h
+#include "ParserBase.h" // bux::T_StateID, bux::F_GetProducedT<>, bux::F_GetProducedRefT<>, LexBase.h
+#include "StrUtil.h"    // HRTN()
 #include "XAutoPtr.h"   // bux::C_AutoNode<>
 #include "Xtack.h"      // bux::C_ResourceStack<>
-#include <stdexcept>    // std::runtime_error
+#include <deque>        // std::deque<>
+#include <format>       // std::format()
+#include <limits>       // std::numeric_limits<>
+#include <memory>       // std::shared_ptr<>, std::weak_ptr<>
+#include <stdexcept>    // std::runtime_error, std::out_of_range
 
 namespace bux {
 namespace LR1 {
@@ -24,13 +29,14 @@ enum
 //
 typedef C_AutoNode<I_LexAttr> C_LexPtr;
 typedef F_GetProducedT<I_LexAttr,C_AutoNode> F_GetProduced;
+typedef F_GetProducedRefT<I_LexAttr,C_AutoNode> F_GetProducedRef;
 
 class C_Parser;
 
 struct I_ParserPolicy
 {
     // Types
-    typedef std::function<void(C_Parser &parser, const F_GetProduced &args, C_LexPtr &ret)> FH_Reduce;
+    typedef std::function<void(C_Parser &parser, const F_GetProducedRef &args, C_LexPtr &ret)> FH_Reduce;
 
     struct C_ReduceInfo
     {
@@ -51,6 +57,9 @@ struct I_ParserPolicy
         ///< Return action kind
     virtual bool changeToken(T_LexID &token, C_LexPtr &attr) const;
         ///< A chance to save action error
+    virtual bool cloneLex(const C_LexPtr &src, C_LexPtr &dst) const;
+        ///< Copy \em src for C_Parser::checkpoint(), sharing what is never modified if possible. Return false if not
+        ///< cloneable. Only null \em src is by default
     virtual size_t getAcceptId() const =0;
         ///< Return id which will be passed as the 1st arg of getReduceInfo()
     virtual bool getTokenName(T_LexID token, std::string &name) const;
@@ -68,63 +77,269 @@ struct I_ParserPolicy
 
 typedef C_LexInfoT<I_LexAttr,C_AutoNode> C_LexInfo;
 
-class C_Parser: public I_Parser
+struct C_StateLR1: C_LexInfo
+{
+    // Data
+    T_StateID           m_StateID{};
+    T_LexID             m_TokenID{};
+    size_t              m_FirstToken{};     ///< Index of the first token reduced into it
+};
+typedef C_ResourceStack<C_StateLR1> C_StateStackLR1;
+
+class C_Produced
+/*! Non-owning view of the symbols popped by a reduction, callable the same way as F_GetProduced and converted to F_GetProducedRef
+*/
 {
 public:
 
+    // Nonvirtuals
+    C_Produced(C_StateLR1 *base, size_t size, size_t prodId) noexcept: m_Base(base), m_Size(size), m_ProdId(prodId) {}
+    C_LexInfo &operator()(size_t n) const
+    {
+        if (n >= m_Size)
+            throw std::out_of_range{"Production["+std::to_string(m_ProdId)+"] out of range "+std::to_string(n)+'/'+std::to_string(m_Size)};
+
+        return m_Base[n];
+    }
+    size_t size() const noexcept { return m_Size; }
+
+private:
+
     // Data
-    const I_ParserPolicy    &m_Policy;
+    C_StateLR1          *const m_Base;
+    const size_t        m_Size;
+    const size_t        m_ProdId;
+};
 
-    // Ctor/Dtor
-    C_Parser(const I_ParserPolicy &policy);
+template<class C_Parser_>
+struct C_ReductionT
+/*! Entry of the reduction table of a policy of C_ParserT<>, indexed by production id
+*/
+{
+    // Types
+    typedef void (*FH_Reduce)(C_Parser_ &parser, const C_Produced &args, C_LexPtr &ret);
+
+    // Data
+    size_t              m_PopLength;
+    T_LexID             m_ResultID;
+    FH_Reduce           m_Reduce;   ///< Null if nothing to do
+};
+
+template<class T_Derived>
+class C_ParserImplT: public I_Parser
+/*! The shift/reduce loop and error recovery shared by C_Parser and C_ParserT<>. \em T_Derived supplies the
+    tables thru these members, as static or nonstatic ones:
+
+    - \c action(state,token), \c nextState(state,lex), \c changeToken(token,attr) and \c printToken(token), as
+      their namesakes in I_ParserPolicy
+    - \c idError() and \c acceptId(), as I_ParserPolicy::m_IdError and I_ParserPolicy::getAcceptId()
+    - \c reduction(id) of members \c m_PopLength, \c m_ResultID and \c m_Reduce, where \c m_Reduce, if not null,
+      is called with the \em T_Derived parser, C_Produced and the C_LexPtr of the result
+    - \c onError(pos,message)
+*/
+{
+public:
 
     // Nonvirtuals
     bool accepted() const { return m_Accepted; }
     auto &getFinalLex() { return m_CurStack.top(); }
-    void onError(const C_SourcePos &pos, std::string_view message);
     void reservePostShift(std::function<void()> calledOnce, unsigned shifts);
+    size_t tokens() const { return m_Tokens; }
+        ///< Count of tokens added thru I_Parser::add()
 
     // Implement I_Parser
     void add(T_LexID token, unsigned line, unsigned col, I_LexAttr *unownedAttr) override;
     std::string_view setSource(std::string_view src) override;
 
-private:
-
-    // Types
-    struct C_StateLR1: C_LexInfo
-    {
-        // Data
-        T_StateID           m_StateID{};
-        T_LexID             m_TokenID{};
-    };
-    typedef C_ResourceStack<C_StateLR1> C_StateStackLR1;
+protected:
 
     // Data
     C_StateStackLR1         m_CurStack;
     std::string_view        m_CurSrc;
-    T_StateID               m_ErrState;
-    T_LexID                 m_ErrToken;
+    T_StateID               m_ErrState{std::numeric_limits<T_StateID>::max()};
+    T_LexID                 m_ErrToken{};
     C_SourcePos             m_ErrPos;
     std::function<void()>   m_OnPostShift;
-    unsigned                m_ShiftCountdown;
-    bool                    m_Accepted;
+    unsigned                m_ShiftCountdown{};
+    bool                    m_Accepted{};
+    size_t                  m_Tokens{};
+    size_t                  m_LowWater{};   ///< Least stack size since C_Parser last took or restored a checkpoint
+    size_t                  m_Errors{};     ///< Count of syntax errors
+
+    // Nonvirtuals
+    C_ParserImplT() = default;
+
+private:
 
     // Nonvirtuals
     void add(T_LexID token, C_LexInfo &info, C_StateStackLR1 &unreadStack);
         // Called by public add() or itself
-    T_StateID currentState() const;
-        //
+    T_StateID currentState() const { return m_CurStack.empty()? 0: m_CurStack.top().m_StateID; }
+        // 0 is reserved as the ID of [ S' -> .S ]
+    T_Derived &derived() { return static_cast<T_Derived&>(*this); }
     void panicRollback(C_StateStackLR1 &unreadStack);
         //
+    void pop(size_t n);
+        // Pop the stack and lower m_LowWater
     bool recover(T_LexID token, C_LexInfo &info, C_StateStackLR1 &unreadStack);
         // Adjust the current state so that parsing can continue.
         // Return true on success
     bool reduceOn(size_t id, const C_SourcePos &pos);
         //
-    void shift(T_LexID lex, C_LexInfo &info);
+    void shift(T_LexID lex, C_LexInfo &info, size_t firstToken);
         // Shift next state thru given token
 };
 
+class C_Parser: public C_ParserImplT<C_Parser>
+{
+    // Types
+    struct C_Frame;
+    struct C_Segment;
+
+public:
+
+    // Types
+    struct C_Checkpoint
+    {
+        std::shared_ptr<C_Segment> m_Stack; ///< Shared with other checkpoints; null if empty
+        size_t              m_Depth{};      ///< Stack size
+        size_t              m_Shared{};     ///< Count of bottom entries untouched since the checkpoint before
+        size_t              m_Tokens{};     ///< Count of tokens added before the checkpoint
+        size_t              m_Errors{};     ///< Count of syntax errors before the checkpoint
+        bool                m_Accepted{};
+    };
+
+    // Data
+    const I_ParserPolicy    &m_Policy;
+
+    // Ctor/Dtor
+    C_Parser(const I_ParserPolicy &policy);
+
+    // Nonvirtuals
+    bool checkpoint(C_Checkpoint &dst, const C_Checkpoint *prev = nullptr);
+        ///< Snapshot the stack with lex attributes cloned by m_Policy.cloneLex(), sharing the entries untouched since
+        ///< \em prev if it is the checkpoint last taken or restored. Return false if not all are cloneable or if
+        ///< reservePostShift() is pending
+    void onError(const C_SourcePos &pos, std::string_view message);
+    void restore(const C_Checkpoint &src);
+        ///< Resume the parse as if only the first \c src.m_Tokens tokens were added. \em src stays reusable
+    bool sameStates(const C_Checkpoint &cp) const;
+        ///< True if the stack runs thru the same states as \em cp does, hence so will the parse of the same tokens ahead
+
+private:
+
+    // Data
+    std::weak_ptr<C_Segment> m_Marked;      // Stack of the checkpoint last taken or restored
+
+    // Nonvirtuals
+    size_t acceptId() const { return m_Policy.getAcceptId(); }
+    size_t action(T_StateID state, T_LexID token) const { return m_Policy.action(state, token); }
+    bool changeToken(T_LexID &token, C_LexPtr &attr) const { return m_Policy.changeToken(token, attr); }
+    T_LexID idError() const { return m_Policy.m_IdError; }
+    T_StateID nextState(T_StateID state, T_LexID lex) const { return m_Policy.nextState(state, lex); }
+    std::string printToken(T_LexID token) const { return m_Policy.printToken(token); }
+    I_ParserPolicy::C_ReduceInfo reduction(size_t id) const;
+    void restoreAbove(const C_Checkpoint &src, size_t depth);
+        // Replace the stack entries from \em depth on with clones of those of \em src and stand where \em src does
+
+    friend class C_ParserImplT<C_Parser>;
+    friend class C_Checkpoints;
+};
+
+class C_Checkpoints
+/*! \brief Checkpoints of a C_Parser every fixed count of tokens, so that an edit is re-parsed only from the last
+           checkpoint before it to where the parse converges with the one before the edit
+
+    Call onAdded() after each C_Parser::add() but that of TID_EOF, and onEnd() before adding TID_EOF. On an edit
+    call resume() and add tokens again from the returned index on until onAdded() returns true, when the rest of
+    the parse before the edit has been spliced in and only TID_EOF is left to add. If it never does, add tokens to
+    the end and call onEnd() again.
+
+    The parse converges at the first checkpoint after the edit, shifted by the change in token count, where the
+    states are the same as before and the stack entries kept by the rest of the parse cover the same unedited
+    tokens. Stacks that fold all input into the bottom entry, e.g. of left-recursive lists, never converge; those
+    keeping list items apart re-parse about an item past the edit, then clone the entries above it from the end.
+    Spliced lexes keep their positions from before the edit, and reductions must depend only on their arguments.
+
+    Each checkpoint clones only the stack entries changed since the one before and shares the rest with it, so
+    lexes holding subtrees, e.g. of an AST, are best cloned by I_ParserPolicy::cloneLex() sharing the subtrees.
+*/
+{
+public:
+
+    // Nonvirtuals
+    explicit C_Checkpoints(size_t interval = DEF_INTERVAL): m_Interval(interval? interval: 1) {}
+    auto &operator[](size_t i) const { return m_Saved[i]; }
+    const C_Parser::C_Checkpoint *find(size_t tokens) const;
+        ///< Checkpoint taken after exactly \em tokens tokens, if any
+    bool onAdded(C_Parser &parser);
+        ///< Return true if the parse resumed by resume() has converged and \em parser stands after the last token
+    void onEnd(C_Parser &parser);
+        ///< Checkpoint the end of input for the parse of later edits to converge on
+    size_t resume(C_Parser &parser, size_t firstEdited, size_t removed, size_t added);
+        ///< For \em removed tokens from index \em firstEdited on replaced by \em added ones, restore \em parser to
+        ///< the last checkpoint before the edit and return the index of the token to add next
+    auto size() const { return m_Saved.size(); }
+
+private:
+
+    // Types
+    struct C_Ahead
+    {
+        C_Parser::C_Checkpoint  m_Checkpoint;
+        size_t                  m_Kept;     // Stack entries below it are never popped later in the parse
+    };
+
+    // Class Constants
+    static constexpr size_t DEF_INTERVAL = 256;
+
+    // Data
+    std::deque<C_Parser::C_Checkpoint>  m_Saved;    // Ascending in m_Tokens
+    std::deque<C_Ahead>                 m_Ahead;    // Checkpoints after the edit being re-parsed, in tokens before it
+    const size_t                        m_Interval;
+    size_t                              m_EditEnd{};    // Token index after the edit
+    size_t                              m_OldEditEnd{}; // Token index after the edit, before it
+    bool                                m_Ended{};      // m_Saved.back() is at the end of input
+
+    // Nonvirtuals
+    bool converge(C_Parser &parser);
+        // Splice the rest of the parse before the edit into parser if it converges at m_Ahead.front()
+    bool save(C_Parser &parser);
+        // Take a checkpoint after the last one
+};
+
+template<class T_Policy>
+class C_ParserT: public C_ParserImplT<C_ParserT<T_Policy>>
+/*! The same parsing as C_Parser, but with the tables & reductions known at compile time as static
+    members of \em T_Policy, so that the shift/reduce loop is inlined and reductions are dispatched
+    thru the function pointers of \c T_Policy::REDUCTIONS[] without copying anything:
+
+    - \c ID_ERROR and \c ACCEPT_ID, as I_ParserPolicy::m_IdError and I_ParserPolicy::getAcceptId()
+    - \c action(state,token) and \c nextState(state,lex), as their namesakes in I_ParserPolicy
+    - \c REDUCTIONS[], array of C_ReductionT<C_ParserT<T_Policy>> indexed by production id
+    - \c onError(parser,pos,message), as I_ParserPolicy::onError()
+    - Optional \c changeToken(token,attr) and \c getTokenName(token,name), as their namesakes in I_ParserPolicy
+*/
+{
+public:
+
+    // Nonvirtuals
+    void onError(const C_SourcePos &pos, std::string_view message) { T_Policy::onError(*this, pos, message); }
+
+private:
+
+    // Class Methods
+    static size_t acceptId() { return T_Policy::ACCEPT_ID; }
+    static size_t action(T_StateID state, T_LexID token) { return T_Policy::action(state, token); }
+    static bool changeToken(T_LexID &token, C_LexPtr &attr);
+    static T_LexID idError() { return T_Policy::ID_ERROR; }
+    static T_StateID nextState(T_StateID state, T_LexID lex) { return T_Policy::nextState(state, lex); }
+    static std::string printToken(T_LexID token);
+    static auto &reduction(size_t id) { return T_Policy::REDUCTIONS[id]; }
+
+    friend class C_ParserImplT<C_ParserT>;
+};
+
 template<class T_Data>
 struct C_NewLex: C_NewNode<C_LexDataT<T_Data>>
 {
@@ -142,5 +357,290 @@ struct C_NewLex: C_NewNode<C_LexDataT<T_Data>>
         C_NewNode<C_LexDataT<T_Data>>(std::forward<T_Args>(args)...) {}
 };
 
+//
+//      Externals
+//
+std::string printTokenId(T_LexID token);
+    ///< Readable name of \em token without the help of the grammar
+
+//
+//      Implement Class Templates
+//
+template<class T_Derived>
+void C_ParserImplT<T_Derived>::add(T_LexID token, unsigned line, unsigned col, I_LexAttr *unownedAttr)
+{
+    C_LexInfo   info;
+    info.m_attr.assign(unownedAttr, true);
+    info.m_pos.m_Source = m_CurSrc;
+    info.m_pos.m_Line = line;
+    info.m_pos.m_Col  = col;
+
+    C_StateStackLR1 unreadStack;
+    add(token, info, unreadStack);
+    ++m_Tokens;
+}
+
+template<class T_Derived>
+void C_ParserImplT<T_Derived>::add(T_LexID token, C_LexInfo &info, C_StateStackLR1 &unreadStack)
+{
+    size_t actionid;
+Again:
+    if (m_Accepted)
+        derived().onError(info, "Already accepted");
+
+    actionid = derived().action(currentState(), token);
+    switch (actionid)
+    {
+    case ACTION_SHIFT:
+        shift(token, info, m_Tokens);
+        if (m_ShiftCountdown && !--m_ShiftCountdown)
+            // Call and forget
+        {
+            std::function<void()> t;
+            t.swap(m_OnPostShift);
+            t();
+        }
+        break;
+    case ACTION_ACCEPT:
+        if (m_OnPostShift)
+            // Call and forget
+        {
+            std::function<void()> t;
+            t.swap(m_OnPostShift);
+            m_ShiftCountdown = 0;
+            t();
+        }
+        if (!reduceOn(derived().acceptId(), info))
+            derived().onError(info, "Reduction error on acception");
+
+        m_Accepted = true;
+        break;
+    case ACTION_ERROR: // Error
+        if (derived().changeToken(token, info.m_attr))
+            goto Again;
+
+        ++m_Errors;
+        if (m_ErrState == std::numeric_limits<T_StateID>::max())
+        {
+            m_ErrState = currentState();
+            m_ErrToken = token;
+            m_ErrPos   = info.m_pos;
+        }
+
+        if (recover(token, info, unreadStack))
+            // Recoverable
+        {
+            info.m_attr.assign(0, false);
+            add(derived().idError(), info, unreadStack);
+        }
+        else
+            // Unrecoverable
+        {
+            auto out = std::format("Syntax error on state={} token={}", m_ErrState, derived().printToken(m_ErrToken));
+            if (auto *attr =info.m_attr.get())
+                out.append(" of attr type ").append(HRTN(*attr));
+            else
+                out += " with null attr";
+
+            if (m_CurStack.empty())
+                out += "\nEmpty stack";
+            else
+            {
+                out += std::format("\nStack[{}] Dump:", m_CurStack.size()-1);
+                bool first = true;
+                for (const auto &i: m_CurStack)
+                {
+                    if (first)
+                        first = false;
+                    else
+                        out += std::format("\n({},{})\t{}\ts={}\tt={}",
+                                i.m_pos.m_Line, i.m_pos.m_Col, i.m_attr?HRTN(*i):"", i.m_StateID, derived().printToken(i.m_TokenID));
+                }
+            }
+            derived().onError(m_ErrPos, out);
+            if (token == TID_EOF)
+                m_Accepted = true;
+            else
+            {
+                panicRollback(unreadStack); // panic mode the cheapest
+                m_ErrState = std::numeric_limits<T_StateID>::max();
+            }
+        }
+        break;
+    default:
+        if (actionid >= ACTION_REDUCE_MIN)
+        {
+            const size_t prodId = actionid - ACTION_REDUCE_MIN;
+            if (reduceOn(prodId, info.m_pos))
+            {
+                m_ErrState = std::numeric_limits<T_StateID>::max();
+                goto Again;
+            }
+            derived().onError(info, "Reduction error on production "+std::to_string(prodId));
+        }
+        derived().onError(info, "Unknown action id "+std::to_string(actionid));
+    } // switch (actionid)
+
+    // Consume unread
+    if (!unreadStack.empty())
+    {
+       token = unreadStack.top().m_TokenID;
+       info = unreadStack.top();
+       unreadStack.pop();
+       goto Again;
+    }
+}
+
+template<class T_Derived>
+void C_ParserImplT<T_Derived>::panicRollback(C_StateStackLR1 &unreadStack)
+{
+    const auto idError = derived().idError();
+    size_t finalSize;
+    for (finalSize = 0; finalSize < m_CurStack.size(); ++finalSize)
+    {
+        if (m_CurStack[finalSize].m_TokenID == idError)
+            break;
+    }
+
+    while (!unreadStack.empty())
+    {
+        m_CurStack.push(unreadStack.top());
+        unreadStack.pop();
+    }
+    while (m_CurStack.size() > finalSize)
+    {
+        C_StateLR1 &top = m_CurStack.top();
+        if (top.m_TokenID != idError)
+            unreadStack.push(top);
+
+        pop(1);
+    }
+}
+
+template<class T_Derived>
+void C_ParserImplT<T_Derived>::pop(size_t n)
+{
+    m_CurStack.pop(n);
+    if (m_LowWater > m_CurStack.size())
+        m_LowWater = m_CurStack.size();
+}
+
+template<class T_Derived>
+bool C_ParserImplT<T_Derived>::recover(T_LexID token, C_LexInfo &info, C_StateStackLR1 &unreadStack)
+{
+    const auto idError = derived().idError();
+    bool isLast = true;
+    for (auto i = m_CurStack.size(); i; --i, isLast = false)
+    {
+        if (!isLast && m_CurStack[i].m_TokenID == idError)
+            // No crossing old idError
+            break;
+
+        if (derived().action(m_CurStack[i-1].m_StateID, idError) != ACTION_ERROR)
+        {
+            if (!isLast && info.m_pos == m_CurStack[i].m_pos)
+                // Total length of nonempty ungotten tokens is zero.
+                continue;
+
+            for (size_t j = i; j; --j, isLast = false)
+            {
+                if (m_CurStack[j-1].m_pos < (isLast?info.m_pos:m_CurStack[j].m_pos))
+                    break;
+                if (m_CurStack[j-1].m_TokenID == idError)
+                    return false;
+            }
+
+            auto &t = unreadStack.push();
+            t.m_TokenID = token;
+            static_cast<C_LexInfo &>(t) = info;
+            while (m_CurStack.size() > i)
+            {
+                unreadStack.push(m_CurStack.top());
+                pop(1);
+            }
+            info.m_pos = unreadStack.top().m_pos;
+            return true;
+        }
+    }
+    return false;
+}
+
+template<class T_Derived>
+bool C_ParserImplT<T_Derived>::reduceOn(size_t id, const C_SourcePos &pos)
+{
+    const auto &ri = derived().reduction(id);
+    if (m_CurStack.size() >= ri.m_PopLength)
+    {
+        const auto base = m_CurStack.end() - ri.m_PopLength;
+        C_LexInfo li;
+        if (ri.m_Reduce)
+            ri.m_Reduce(derived(), C_Produced{base, ri.m_PopLength, id}, li.m_attr);
+
+        auto firstToken = m_Tokens;
+        if (ri.m_PopLength)
+        {
+            li.m_pos = base->m_pos;
+            firstToken = base->m_FirstToken;
+            pop(ri.m_PopLength);
+        }
+        else
+            li.m_pos = pos;
+
+        shift(ri.m_ResultID, li, firstToken);
+        return true;
+    }
+    return false;
+}
+
+template<class T_Derived>
+void C_ParserImplT<T_Derived>::reservePostShift(std::function<void()> calledOnce, unsigned shifts)
+{
+    m_ShiftCountdown = shifts;
+    m_OnPostShift = calledOnce;
+}
+
+template<class T_Derived>
+std::string_view C_ParserImplT<T_Derived>::setSource(std::string_view src)
+{
+    const auto ret = m_CurSrc;
+    m_CurSrc = src;
+    return ret;
+}
+
+template<class T_Derived>
+void C_ParserImplT<T_Derived>::shift(T_LexID token, C_LexInfo &info, size_t firstToken)
+{
+    const auto state = currentState();
+    auto &t = m_CurStack.push();
+    t.m_StateID = token != ROOT_NID? derived().nextState(state, token): state;
+    t.m_TokenID = token;
+    t.m_FirstToken = firstToken;
+    static_cast<C_LexInfo&>(t) = info;
+}
+
+template<class T_Policy>
+bool C_ParserT<T_Policy>::changeToken(T_LexID &token, C_LexPtr &attr)
+{
+    if constexpr (requires { T_Policy::changeToken(token, attr); })
+        return T_Policy::changeToken(token, attr);
+    else
+        return false;
+}
+
+template<class T_Policy>
+std::string C_ParserT<T_Policy>::printToken(T_LexID token)
+{
+    if constexpr (requires(std::string &name) { T_Policy::getTokenName(token, name); })
+    {
+        std::string name;
+        if (T_Policy::getTokenName(token, name))
+            return name;
+    }
+    return printTokenId(token);
+}
+
+extern template class C_ParserImplT<C_Parser>;
+    // Instantiated in LR1.cpp
+
 } // namespace LR1
 } // namespace bux
@@ -5,7 +5,9 @@
 #   pragma warn -8027
 #endif
 
+#include <cstddef>      // std::size_t
 #include <cstdint>      // uint32_t
+#include <new>          // std::align_val_t, std::destroying_delete_t
 #include <stdexcept>    // std::runtime_error
 #include <string>       // std::string, std::to_string()
 #include <string_view>  // std::string_view
@@ -87,11 +89,100 @@ struct C_RetLvalT
     T &operator *() const { return *m_lval; }
 };
 
+class C_LexArena
+/*! Per-parse monotonic arena of lexes. While alive, it is the current arena of the thread creating it,
+    and all I_LexAttr objects newed by the thread, e.g. by createLex(), \c LR1::C_NewLex<> and C_NewNode<>,
+    are carved out of it instead of the heap.
+
+    Deleting them still runs their destructors, but their memory is released in one shot when both the
+    arena and all lexes carved out of it are gone. So lexes, e.g. the final parse tree, can safely
+    outlive the arena.
+
+    Arenas of the same thread nest, and must be destroyed in reverse order of creation.
+*/
+{
+public:
+
+    // Nonvirtuals
+    explicit C_LexArena(std::size_t initialBytes = DEF_INITIAL_BYTES);
+    C_LexArena(const C_LexArena&) = delete;
+    C_LexArena &operator=(const C_LexArena&) = delete;
+    ~C_LexArena();
+    std::size_t allocations() const noexcept;
+        ///< Number of lexes carved out so far
+    std::size_t bytes() const noexcept;
+        ///< Sum of sizes of lexes carved out so far
+
+    // Class Methods
+    static C_LexArena *current() noexcept;
+        ///< Innermost arena of the calling thread, or nullptr
+
+    // Class Constants
+    static constexpr std::size_t DEF_INITIAL_BYTES = 16 << 10;
+
+private:
+
+    // Types
+    struct C_Pool;
+
+    // Data
+    C_Pool                  *const m_Pool;
+    C_LexArena              *const m_Outer;
+    static inline thread_local C_LexArena *t_curArena{};
+
+    // Class Methods
+    static void *carve(std::size_t bytes);
+    static C_Pool *ownerOf(const void *p) noexcept;
+        ///< Pool of the current arena if it owns \em p, or nullptr
+    static void release(C_Pool *pool) noexcept;
+
+    friend struct I_LexAttr;
+};
+
 struct I_LexAttr
 /*! Convenient base of all token types, terminals or non-terminals, for a specific parser framework.
+
+    Instances newed by a thread with a live C_LexArena are carved out of the arena. Each instance keeps
+    the arena pool it comes from, if any, so that heap instances are newed and deleted as cheaply as ever.
 */
 {
+    // Nonvirtuals
+    I_LexAttr() noexcept: m_Pool(C_LexArena::t_curArena? C_LexArena::ownerOf(this): nullptr) {}
+    I_LexAttr(const I_LexAttr&) noexcept: I_LexAttr() {}
+        ///< The origin of memory is never copied
+    I_LexAttr &operator=(const I_LexAttr&) noexcept { return *this; }
     virtual ~I_LexAttr() = 0;
+
+    // Class Methods
+    static void *operator new(std::size_t bytes)
+        { return C_LexArena::t_curArena? C_LexArena::carve(bytes): ::operator new(bytes); }
+    static void *operator new(std::size_t, void *place) noexcept { return place; }
+    static void *operator new(std::size_t bytes, std::align_val_t align) { return ::operator new(bytes, align); }
+        ///< Over-aligned types never go to arenas
+    static void operator delete(I_LexAttr *p, std::destroying_delete_t, std::size_t bytes, std::align_val_t align) noexcept
+    /*! Destroy \em p and return its memory to where it comes from. \em bytes and \em align are of the
+        most derived type.
+    */
+    {
+        const auto pool = p->m_Pool;
+        const auto base = dynamic_cast<void*>(p); // Most derived object, where the memory starts
+        p->~I_LexAttr();
+        if (pool)
+            C_LexArena::release(pool);
+        else if (std::size_t(align) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(base, bytes, align);
+        else
+            ::operator delete(base, bytes);
+    }
+    static void operator delete(void *p) noexcept;
+        ///< Only used when a constructor throws
+    static void operator delete(void *p, std::align_val_t align) noexcept { ::operator delete(p, align); }
+    static void operator delete(void *, void *) noexcept {}
+
+private:
+
+    // Data
+    C_LexArena::C_Pool      *const m_Pool;  ///< Arena pool of the memory, or nullptr
 };
 
 struct I_Parser
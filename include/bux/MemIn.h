@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>    // std::min()
+#include <ios>          // std::ios_base, std::streamsize
 #include <istream>      // std::basic_istream<>
 #include <string_view>  // std::basic_string_view<>
 
@@ -13,7 +15,15 @@ struct C_IMemBufAsMember
 {
     // Data
     struct C_IMemBuf: std::basic_streambuf<_CharT,_Traits>
+    /*! Read-only streambuf over a caller-owned buffer, with random access & bulk read.
+    */
     {
+        // Types
+        typedef std::basic_streambuf<_CharT,_Traits> C_Super;
+        typedef typename C_Super::pos_type pos_type;
+        typedef typename C_Super::off_type off_type;
+
+        // Nonvirtuals
         C_IMemBuf(const _CharT *buffer, size_t size)
         {
             const auto beg = const_cast<_CharT*>(buffer);
@@ -24,6 +34,64 @@ struct C_IMemBufAsMember
             const auto beg = const_cast<_CharT*>(buffer.data());
             this->setg(beg, beg, beg+buffer.size());
         }
+        auto view_remaining() const noexcept
+        {
+            return std::basic_string_view<_CharT,_Traits>{this->gptr(), size_t(this->egptr() - this->gptr())};
+        }
+
+    protected:
+
+        // Implement std::basic_streambuf<>
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+        {
+            off_type base;
+            switch (dir)
+            {
+            case std::ios_base::beg:
+                base = 0;
+                break;
+            case std::ios_base::cur:
+                base = this->gptr() - this->eback();
+                break;
+            case std::ios_base::end:
+                base = this->egptr() - this->eback();
+                break;
+            default:
+                return pos_type(off_type(-1));
+            }
+            return seekTo(base + off, which);
+        }
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+        {
+            return seekTo(off_type(pos), which);
+        }
+        std::streamsize showmanyc() override
+        {
+            const auto n = this->egptr() - this->gptr();
+            return n? n: -1;
+        }
+        std::streamsize xsgetn(_CharT *s, std::streamsize n) override
+        {
+            n = std::min<std::streamsize>(n, this->egptr() - this->gptr());
+            if (n > 0)
+            {
+                _Traits::copy(s, this->gptr(), size_t(n));
+                this->setg(this->eback(), this->gptr() + n, this->egptr());
+            }
+            return n;
+        }
+
+    private:
+
+        // Nonvirtuals
+        pos_type seekTo(off_type pos, std::ios_base::openmode which)
+        {
+            if (!(which & std::ios_base::in) || pos < 0 || pos > this->egptr() - this->eback())
+                return pos_type(off_type(-1));
+
+            this->setg(this->eback(), this->eback() + pos, this->egptr());
+            return pos_type(pos);
+        }
     } m_Buffer;
 
     // Ctor
@@ -36,6 +104,9 @@ template <class _CharT, class _Traits = std::char_traits<_CharT>>
 class C_IMemStreamT:
     private C_IMemBufAsMember<_CharT,_Traits>,
     public std::basic_istream<_CharT,_Traits> // Inheritance order matters
+/*! Input stream over a caller-owned buffer, e.g. bux::C_FileAsMemory::view(), without copying it.
+    Both tellg() & seekg() work, and read() is a single copy.
+*/
 {
 public:
 
@@ -52,6 +123,10 @@ public:
         C_IMemStreamT(std::basic_string_view<_CharT,_Traits>{str})
         {}
     C_IMemStreamT(std::basic_string<_CharT,_Traits> &&) = delete;
+
+    // Nonvirtuals
+    auto view_remaining() const noexcept { return this->m_Buffer.view_remaining(); }
+        ///< Unread part of the buffer, to be parsed in place.
 };
 using C_IMemStream = C_IMemStreamT<char>;
 
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <algorithm>    // std::max()
+#include <climits>      // INT_MAX
 #include <ostream>      // std::basic_ostream<>
 #include <span>         // std::span<>
+#include <string>       // std::basic_string<>
+#include <string_view>  // std::basic_string_view<>
+#include <utility>      // std::move()
 
 namespace bux {
 
@@ -17,7 +22,9 @@ struct C_OMemBufAsMemberT
         C_OMemBuf(_CharT *buffer, size_t size)
         { this->setp(buffer, buffer+size); }
         C_OMemBuf(std::span<_CharT> buffer)
-        { this->setp(buffer.begin(), buffer.end()); }
+        { this->setp(buffer.data(), buffer.data()+buffer.size()); }
+        size_t size() const
+        { return size_t(this->pptr() - this->pbase()); }
     }   m_Buffer;
 
     // Ctor
@@ -41,7 +48,131 @@ public:
         C_OMemBufAsMemberT<_CharT,_Traits>(buffer),
         std::basic_ostream<_CharT,_Traits>(&this->m_Buffer)
         {}
+
+    // Nonvirtuals
+    size_t size() const { return this->m_Buffer.size(); }
+        ///< Count of characters written so far
 };
 using C_OMemStream = C_OMemStreamT<char>;
 
+template <class _CharT, class _Traits =std::char_traits<_CharT>>
+class C_OGrowMemBufT: public std::basic_streambuf<_CharT,_Traits>
+/*! Output buffer which grows geometrically instead of going bad when full,
+    and whose content can be viewed or moved out without being copied.
+*/
+{
+public:
+
+    // Types
+    typedef std::basic_string<_CharT,_Traits> C_String;
+    typedef std::basic_string_view<_CharT,_Traits> C_View;
+
+    // Nonvirtuals
+    explicit C_OGrowMemBufT(size_t reserve = 0)
+    {
+        if (reserve)
+            grow(reserve);
+    }
+    C_OGrowMemBufT(const C_OGrowMemBufT &) = delete;
+    C_OGrowMemBufT &operator=(const C_OGrowMemBufT &) = delete;
+    void clear()
+        ///< Discard the content but keep the capacity
+    { this->setp(m_buf.data(), m_buf.data()+m_buf.size()); }
+    C_String release()
+        ///< Move out the content and start over empty
+    {
+        m_buf.resize(size());
+        C_String ret = std::move(m_buf);
+        m_buf.clear();
+        this->setp(nullptr, nullptr);
+        return ret;
+    }
+    size_t size() const
+    { return size_t(this->pptr() - this->pbase()); }
+    C_View view() const
+    { return {this->pbase(), size()}; }
+
+protected:
+
+    // Overrides
+    typename _Traits::int_type overflow(typename _Traits::int_type c) override
+    {
+        if (_Traits::eq_int_type(c, _Traits::eof()))
+            return _Traits::not_eof(c);
+
+        grow(1);
+        *this->pptr() = _Traits::to_char_type(c);
+        this->pbump(1);
+        return c;
+    }
+    std::streamsize xsputn(const _CharT *s, std::streamsize n) override
+    {
+        if (n <= 0)
+            return 0;
+
+        const auto bytes = size_t(n);
+        if (bytes > size_t(this->epptr() - this->pptr()))
+            grow(bytes);
+
+        _Traits::copy(this->pptr(), s, bytes);
+        advance(bytes);
+        return n;
+    }
+
+private:
+
+    // Data
+    C_String    m_buf;
+
+    // Nonvirtuals
+    void advance(size_t n)
+    {
+        for (; n > size_t(INT_MAX); n -= size_t(INT_MAX))
+            this->pbump(INT_MAX);
+
+        this->pbump(int(n));
+    }
+    void grow(size_t extra)
+    {
+        const auto used = size();
+        m_buf.resize(std::max({used + extra, m_buf.size() * 2, size_t(64)}));
+        this->setp(m_buf.data(), m_buf.data()+m_buf.size());
+        advance(used);
+    }
+};
+
+template <class _CharT, class _Traits>
+struct C_OGrowMemBufAsMemberT
+{
+    // Data
+    C_OGrowMemBufT<_CharT,_Traits> m_Buffer;
+
+    // Ctor
+    C_OGrowMemBufAsMemberT(size_t reserve): m_Buffer(reserve) {}
+};
+
+template <class _CharT, class _Traits =std::char_traits<_CharT>>
+class C_OGrowMemStreamT:
+    private C_OGrowMemBufAsMemberT<_CharT,_Traits>,
+    public std::basic_ostream<_CharT,_Traits> // Inheritance order matters
+/*! Drop-in replacement of std::basic_ostringstream<> with view() & release() free of copying
+*/
+{
+public:
+
+    // Ctor
+    explicit C_OGrowMemStreamT(size_t reserve = 0):
+        C_OGrowMemBufAsMemberT<_CharT,_Traits>(reserve),
+        std::basic_ostream<_CharT,_Traits>(&this->m_Buffer)
+        {}
+
+    // Nonvirtuals
+    auto release() { return this->m_Buffer.release(); }
+    void reset() { this->m_Buffer.clear(); this->clear(); }
+        ///< Discard the content, keep the capacity and reset the stream state
+    auto size() const { return this->m_Buffer.size(); }
+    auto view() const { return this->m_Buffer.view(); }
+};
+using C_OGrowMemStream = C_OGrowMemStreamT<char>;
+
 } // namespace bux
@@ -1,11 +1,11 @@
 #pragma once
 
+#include "MemOut.h"     // bux::C_OGrowMemStream
 #include "SyncLog.h"    // bux::I_SyncLog, bux::I_ReenterableLog, bux::C_ReenterableOstream
 #include <concepts>     // std::derived_from<>, std::convertible_to<>
 #include <functional>   // std::function<>
 #include <list>         // std::list<>
 #include <memory>       // std::unique_ptr<>
-#include <sstream>      // std::ostringstream
 #include <string_view>  // std::string_view
 #include <vector>       // std::vector<>
 
@@ -87,7 +87,7 @@ private:
     // Data
     std::recursive_mutex    m_lock;
     C_Node                  m_root;
-    std::list<std::pair<C_LockedNode,std::ostringstream>> m_lockedStack;
+    std::list<std::pair<C_LockedNode,C_OGrowMemStream>> m_lockedStack;
 
     // Nonvirtuals
     std::ostream *lockLog(const std::function<std::ostream*(I_ReenterableLog&)> &to_log);
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "FileAsMem.h"      // bux::C_FileAsMemory
+#include "ParserBase.h"     // bux::C_ParserLogCount
+#include "ScannerBase.h"    // bux::I_Scanner<>, bux::scanFile()
+#include <algorithm>        // std::min()
+#include <atomic>           // std::atomic<>
+#include <chrono>           // std::chrono::steady_clock
+#include <concepts>         // std::convertible_to<>
+#include <exception>        // std::exception_ptr, std::current_exception()
+#include <filesystem>       // std::filesystem::path
+#include <memory>           // std::unique_ptr<>
+#include <span>             // std::span<>
+#include <string>           // std::string
+#include <thread>           // std::jthread, std::thread::hardware_concurrency()
+#include <type_traits>      // std::is_pointer_v<>
+#include <vector>           // std::vector<>
+
+namespace bux {
+
+//
+//      Types
+//
+class C_ParserLogBuffer: public C_ParserLogCount
+/*! Keep log lines of one parse in memory so that files parsed in parallel
+    can be reported one after another.
+*/
+{
+public:
+
+    // Nonvirtuals
+    auto &lines() const { return m_lines; }
+
+private:
+
+    // Data
+    std::vector<std::string>    m_lines;
+
+    // Implement C_ParserLogCount
+    void println(const std::string &line) override { m_lines.emplace_back(line); }
+};
+
+template<class T_Char>
+struct C_ScanPairT
+/*! A parser and the scanner feeding it, created by a worker thread for each file it scans.
+*/
+{
+    // Data
+    std::unique_ptr<I_Parser>           m_parser;
+    std::unique_ptr<I_Scanner<T_Char>>  m_scanner;  ///< Declared last to be destroyed first
+};
+
+struct C_ScannedFile
+{
+    // Data
+    std::filesystem::path               m_path;
+    std::string                         m_source;   ///< Source name passed to the scanner
+    C_ParserLogBuffer                   m_log;
+    size_t                              m_bytes{};
+    std::chrono::steady_clock::duration m_elapsed{};
+    std::exception_ptr                  m_error;    ///< Non-null if scanning or parsing threw
+};
+
+struct C_ScanFilesReport
+{
+    // Data
+    std::vector<C_ScannedFile>          m_files;    ///< In the same order as input paths
+    std::chrono::steady_clock::duration m_wallTime{};
+    std::chrono::steady_clock::duration m_busyTime{};   ///< Sum of \c m_elapsed of all files
+    size_t                              m_totalBytes{};
+    unsigned                            m_threads{};
+
+    // Nonvirtuals
+    double parallelism() const
+    {
+        return m_wallTime.count()? double(m_busyTime.count()) / double(m_wallTime.count()): 0;
+    }
+};
+
+//
+//      Function Templates
+//
+template<class T_Char, class F_NewPair, class F_Parsed = void(*)(size_t,I_Parser&)>
+C_ScanFilesReport scanFiles(
+    std::span<const std::filesystem::path>  paths,
+    F_NewPair                               newPair,
+    F_Parsed                                parsed      = nullptr,
+    unsigned                                threads     = 0,
+    T_LexID                                 endToken    = TID_EOF,
+    T_Encoding                              encoding    = 0) requires
+    requires (size_t i, C_ParserLogCount &log) {
+        { newPair(i, log) }-> std::convertible_to<C_ScanPairT<T_Char>>;
+    }
+/*! \param [in] paths Files to scan and parse.
+    \param [in] newPair Called as <tt>newPair(index, log)</tt> to create the scanner/parser pair for
+                <tt>paths[index]</tt>, whose parser is expected to report to \c log.
+    \param [in] parsed If not null, called as <tt>parsed(index, parser)</tt> after the file is fully
+                scanned, so that the parsed result can be taken out before the pair is gone.
+    \param [in] threads Number of worker threads; 0 for std::thread::hardware_concurrency()
+    \param [in] endToken Token added to each scanner at the end of file.
+    \param [in] encoding Encoding passed to bux::C_UnicodeIn
+    \return Per-file log counts & timing, plus the overall statistics.
+
+    Each file is memory-mapped and then driven through scanFile() by whichever worker picks it up.
+    Both \c newPair and \c parsed may be called concurrently from different worker threads.
+*/
+{
+    using C_Clock = std::chrono::steady_clock;
+
+    C_ScanFilesReport ret;
+    ret.m_files.resize(paths.size());
+    if (!threads)
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    ret.m_threads = unsigned(std::min<size_t>(threads, paths.size()));
+
+    std::atomic<size_t> next{0};
+    const auto work = [&]{
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < paths.size();)
+        {
+            auto &dst = ret.m_files[i];
+            dst.m_path = paths[i];
+            dst.m_source = dst.m_path.string();
+            const auto start = C_Clock::now();
+            try
+            {
+                const C_FileAsMemory map{dst.m_path, MA_SEQUENTIAL};
+                dst.m_bytes = map.size();
+                C_ScanPairT<T_Char> pair = newPair(i, dst.m_log);
+                C_UnicodeIn src(map.view(), encoding);
+                scanFile(dst.m_source, src, *pair.m_scanner, endToken);
+                if constexpr (std::is_pointer_v<F_Parsed>)
+                {
+                    if (parsed)
+                        parsed(i, *pair.m_parser);
+                }
+                else
+                    parsed(i, *pair.m_parser);
+            }
+            catch (...)
+            {
+                dst.m_error = std::current_exception();
+            }
+            dst.m_elapsed = C_Clock::now() - start;
+        }
+    };
+
+    const auto start = C_Clock::now();
+    if (ret.m_threads > 1)
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(ret.m_threads);
+        for (unsigned i = 0; i < ret.m_threads; ++i)
+            workers.emplace_back(work);
+    }
+    else
+        work();
+
+    ret.m_wallTime = C_Clock::now() - start;
+    for (auto &i: ret.m_files)
+    {
+        ret.m_busyTime += i.m_elapsed;
+        ret.m_totalBytes += i.m_bytes;
+    }
+    return ret;
+}
+
+} //namespace bux
@@ -6,8 +6,11 @@
 #include <array>        // std::array<>
 #include <functional>   // std::function<>
 #include <limits>       // std::numeric_limits<>
+#include <memory>       // std::addressof()
+#include <stdexcept>    // std::invalid_argument
 #include <string_view>  // std::string_view
-#include <type_traits>  // std::is_const<>, std::is_pointer<>, std::add_const_t<>
+#include <type_traits>  // std::is_const<>, std::is_pointer<>, std::add_const_t<>, std::is_invocable_r_v<>
+#include <vector>       // std::vector<>
 
 namespace bux {
 
@@ -19,6 +22,37 @@ using T_StateID = unsigned;
 template<class T, template<class> class C_Ptr>
 using F_GetProducedT = std::function<C_LexInfoT<T,C_Ptr> &(size_t)>;
 
+template<class T, template<class> class C_Ptr>
+class F_GetProducedRefT
+/*! \brief Non-owning reference to any callable of <tt>C_LexInfoT<T,C_Ptr> &(size_t)</tt>
+
+    What parsers hand to reduction handlers, two pointers to copy instead of a type-erased F_GetProducedT<>
+    which may allocate. The referred callable must outlive the reference, which is only the duration of the
+    reduction call. Handlers taking F_GetProducedT<> instead still work, since it converts to one.
+*/
+{
+public:
+
+    // Types
+    typedef C_LexInfoT<T,C_Ptr> C_LexInfo;
+
+    // Nonvirtuals
+    template<class F> requires (!std::is_same_v<std::remove_cvref_t<F>,F_GetProducedRefT>
+                                && std::is_invocable_r_v<C_LexInfo&,F&,size_t>)
+    F_GetProducedRefT(F &&f) noexcept:
+        m_obj(const_cast<void*>(static_cast<const void*>(std::addressof(f)))),
+        m_call([](void *obj, size_t n)->C_LexInfo& { return (*static_cast<std::remove_reference_t<F>*>(obj))(n); })
+        {}
+    C_LexInfo &operator()(size_t n) const
+        { return m_call(m_obj, n); }
+
+private:
+
+    // Data
+    void        *m_obj;
+    C_LexInfo   &(*m_call)(void *obj, size_t n);
+};
+
 template<class T, template<class> class C_Ptr>
 class FC_GetRelLexT
 {
@@ -54,6 +88,84 @@ union U_K2V
     constexpr U_K2V(int (*conv)(T_Key)): m_conv(conv) {}
 };
 
+template<class T_Value>
+struct C_CombTable
+/*! \brief Row-displacement (comb-vector) compression of the sparse rows of a parse table
+
+    Entry (row, key) lives in slot <tt>m_base[row] + column(key)</tt> if <tt>m_check[slot] == row</tt>, so a
+    lookup costs two array reads instead of a binary search. Columns of single-character tokens come first,
+    followed by those of token ids from \c MIN_TOKEN_ID on. Rows left sparse, i.e. <tt>m_base[row] == NO_ROW</tt>,
+    are resolved by index2value() as before.
+*/
+{
+    // Class Constants
+    static constexpr int NO_ROW = std::numeric_limits<int>::min();
+    static constexpr T_StateID NO_STATE = std::numeric_limits<T_StateID>::max();
+
+    // Data
+    const int           *m_base;        ///< Indexed by row, or NO_ROW if the row is not in the comb
+    const T_StateID     *m_check;       ///< Owner row of each slot, NO_STATE if vacant
+    const T_Value       *m_values;      ///< Value of each slot
+    size_t              m_rows;         ///< Count of rows in \c m_base; rows beyond are not in the comb
+    size_t              m_size;         ///< Count of slots
+    T_LexID             m_charSpan;     ///< Count of columns for single-character tokens
+
+    // Nonvirtuals
+    constexpr bool hasRow(T_StateID row) const { return row < m_rows && m_base[row] != NO_ROW; }
+    constexpr T_Value lookup(T_StateID row, T_LexID key, T_Value error) const
+    {
+        size_t col;
+        if (key >= MIN_TOKEN_ID)
+            col = size_t(m_charSpan) + (key - MIN_TOKEN_ID);
+        else if (key < m_charSpan)
+            col = key;
+        else
+            return error;
+
+        if (row >= m_rows)
+            return error;
+
+        const auto slot = size_t(m_base[row]) + col; // Negative sum wraps beyond m_size
+        return slot < m_size && m_check[slot] == row? m_values[slot]: error;
+    }
+};
+
+template<class T_Value>
+class C_CombBuilder
+/*! \brief Pack rows into a C_CombTable<T_Value> by first fit, for parser generators to emit as arrays or for
+           parsers to build at startup
+
+    Rows with fewer than \em minKeys keys are left to index2value(), since a binary search over a handful of
+    keys is as cheap as the comb and takes no extra slots.
+*/
+{
+public:
+
+    // Nonvirtuals
+    explicit C_CombBuilder(T_LexID charSpan, size_t minKeys = DEF_MIN_KEYS): m_charSpan(charSpan), m_minKeys(minKeys) {}
+    template<class T_Key>
+    bool addRow(T_StateID row, const C_KVPair<T_Key,T_Value> *sortedEntries, size_t count);
+    auto &base() const { return m_base; }
+    auto &check() const { return m_check; }
+    auto &values() const { return m_values; }
+    C_CombTable<T_Value> table() const
+        { return {m_base.data(), m_check.data(), m_values.data(), m_base.size(), m_check.size(), m_charSpan}; }
+
+private:
+
+    // Class Constants
+    static constexpr size_t DEF_MIN_KEYS = 4;
+
+    // Data
+    std::vector<int>        m_base;
+    std::vector<T_StateID>  m_check;
+    std::vector<T_Value>    m_values;
+    std::vector<size_t>     m_cols;
+    const T_LexID           m_charSpan;
+    const size_t            m_minKeys;
+    size_t                  m_firstVacant{};
+};
+
 template<class T, bool>
 struct T_CoConst_;
 template<class T_Data, class T_Dep>
@@ -135,6 +247,17 @@ T_Value index2value(U_K2V<T_Key,T_Value> k2v, T_ValueOrSize valOrSz, T_LexID key
     return T_Traits::valueError();
 }
 
+template<class T_Key, class T_Value, class T_ValueOrSize, class T_Traits>
+T_Value index2value(const C_CombTable<T_Value> &comb, T_StateID row, U_K2V<T_Key,T_Value> k2v, T_ValueOrSize valOrSz, T_LexID key)
+/*! Resolve (row, key) by the comb if the generator put the row in, or else by the sparse row (k2v, valOrSz)
+*/
+{
+    if (comb.hasRow(row))
+        return comb.lookup(row, key, T_Traits::valueError());
+
+    return index2value<T_Key,T_Value,T_ValueOrSize,T_Traits>(k2v, valOrSz, key);
+}
+
 template<class T>
 auto &unlex(I_LexAttr &lex)
 {
@@ -181,4 +304,80 @@ int toInt(const C_LexInfoT<T_Lex,C_Ptr> &lex)
     return t.value<int>();
 }
 
+//
+//      Implement Class Templates
+//
+template<class T_Value>
+template<class T_Key>
+bool C_CombBuilder<T_Value>::addRow(T_StateID row, const C_KVPair<T_Key,T_Value> *sortedEntries, size_t count)
+/*! \param [in] row State id, added in any order but at most once
+    \param [in] sortedEntries Entries of the row sorted by key, i.e. the table index2value() would search
+    \param [in] count Count of \em sortedEntries
+    \retval true The row is packed into the comb
+    \retval false The row is left to index2value()
+*/
+{
+    if (row >= m_base.size())
+        m_base.resize(row + 1, C_CombTable<T_Value>::NO_ROW);
+    else if (m_base[row] != C_CombTable<T_Value>::NO_ROW)
+        throw std::invalid_argument{"Row " + std::to_string(row) + " added twice"};
+
+    if (!count || count < m_minKeys)
+        // Empty rows take no slots even if minKeys is 0
+        return false;
+
+    m_cols.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto key = T_LexID(sortedEntries[i].m_key);
+        if (key >= MIN_TOKEN_ID)
+            m_cols.emplace_back(size_t(m_charSpan) + (key - MIN_TOKEN_ID));
+        else if (key < m_charSpan)
+            m_cols.emplace_back(key);
+        else
+            throw std::invalid_argument{"Key " + std::to_string(key) + " beyond char span " + std::to_string(m_charSpan)};
+
+        if (m_cols.size() > 1 && m_cols.end()[-2] >= m_cols.back())
+            throw std::invalid_argument{"Keys of row " + std::to_string(row) + " not strictly ascending"};
+    }
+
+    // First fit, with the leftmost key no earlier than the first vacant slot
+    const auto minCol = m_cols.front(), span = m_cols.back() - minCol;
+    auto slot0 = m_firstVacant;
+    for (;; ++slot0)
+    {
+        bool fit = true;
+        for (auto c: m_cols)
+        {
+            const auto slot = slot0 + (c - minCol);
+            if (slot < m_check.size() && m_check[slot] != C_CombTable<T_Value>::NO_STATE)
+            {
+                fit = false;
+                break;
+            }
+        }
+        if (fit)
+            break;
+    }
+    if (minCol >= size_t(std::numeric_limits<int>::max()) || slot0 + span >= size_t(std::numeric_limits<int>::max()))
+        throw std::invalid_argument{"Comb overflow"};
+
+    if (slot0 + span >= m_check.size())
+    {
+        m_check.resize(slot0 + span + 1, C_CombTable<T_Value>::NO_STATE);
+        m_values.resize(m_check.size());
+    }
+    for (size_t i = 0; i < m_cols.size(); ++i)
+    {
+        const auto slot = slot0 + (m_cols[i] - minCol);
+        m_check[slot] = row;
+        m_values[slot] = sortedEntries[i].m_value;
+    }
+    m_base[row] = int(slot0) - int(minCol); // Negative if minCol > slot0
+    while (m_firstVacant < m_check.size() && m_check[m_firstVacant] != C_CombTable<T_Value>::NO_STATE)
+        ++m_firstVacant;
+
+    return true;
+}
+
 } //namespace bux
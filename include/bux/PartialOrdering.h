@@ -1,7 +1,21 @@
 #pragma once
 
-#include <concepts>     // std::constructible_from<>, std::equality_comparable<>, std::invocable<>
+#include <algorithm>    // std::copy_n(), std::sort(), std::unique(), std::max(), std::min(), std::push_heap(), std::pop_heap()
+#include <atomic>       // std::atomic<>
+#include <chrono>       // std::chrono::steady_clock
+#include <concepts>     // std::constructible_from<>, std::convertible_to<>, std::equality_comparable<>, std::invocable<>, std::totally_ordered<>
+#include <cstdint>      // std::uint64_t
+#include <deque>        // std::deque<>
+#include <exception>    // std::exception_ptr, std::current_exception(), std::rethrow_exception()
+#include <functional>   // std::hash<>
 #include <list>         // std::list<>
+#include <map>          // std::map<>
+#include <mutex>        // std::mutex, std::scoped_lock<>
+#include <thread>       // std::jthread, std::thread::hardware_concurrency()
+#include <type_traits>  // std::conditional_t<>, std::invoke_result_t<>
+#include <unordered_map>// std::unordered_map<>
+#include <utility>      // std::pair<>
+#include <vector>       // std::vector<>
 
 namespace bux {
 
@@ -14,12 +28,42 @@ enum E_MakeLinearPolicy
     MLP_DEPTH_FIRST
 };
 
+struct C_ScheduleReport
+/*! What C_PartialOrdering::schedule() has achieved
+*/
+{
+    // Data
+    std::chrono::steady_clock::duration m_wallTime{};
+    std::chrono::steady_clock::duration m_busyTime{};   ///< Sum of time spent on each node
+    double                              m_totalCost{};  ///< Sum of cost hints of all nodes
+    double                              m_criticalPath{};   ///< Largest sum of cost hints along a chain of related nodes
+    std::size_t                         m_nodes{};
+    std::size_t                         m_steals{};     ///< Nodes run by threads other than the one which readied them
+    unsigned                            m_threads{};
+
+    // Nonvirtuals
+    double parallelism() const
+    {
+        return m_wallTime.count()? double(m_busyTime.count()) / double(m_wallTime.count()): 0;
+    }
+    double maxParallelism() const { return m_criticalPath > 0? m_totalCost / m_criticalPath: 0; }
+        ///< Upper bound of parallelism() if the cost hints are accurate
+};
+
 template<std::equality_comparable T>
 class C_PartialOrdering
 /*! \e DEFINITIONs:
     Let R be a partial ordering and aRb. Then a is said to be "left-related"
     to b, and similarly b is "right-related" to a. If no x in fld R satisfies
     xRa, a is said to be a "leftmost" in R. "Rightmost" is defined similarly.
+
+    Nodes are interned as dense indices, by std::hash<T> if available, or else by std::map if T is
+    totally ordered, or else by linear search. Edges are kept in order of addition and indexed by both
+    ends, so that each query walks only the part of the relation it needs.
+
+    Up to a given number of nodes, the transitive closure is also kept as one bitset per node and
+    updated by each addOrder(), so that related() and the cycle check of addOrder() take O(1) time.
+    Beyond that, reachability is searched depth-first.
 */
 {
 public:
@@ -28,6 +72,9 @@ public:
     typedef std::list<T> C_ValList;
 
     // Nonvirtuals
+    C_PartialOrdering() = default;
+    explicit C_PartialOrdering(std::size_t maxClosureNodes): m_MaxClosureNodes(maxClosureNodes) {}
+        ///< Keep the transitive closure until there are more than \em maxClosureNodes nodes
     template<class T1, class T2>
     [[nodiscard]]bool addOrder(T1 a, T2 b);
         // Return true if given order (a,b) is successfully added
@@ -35,10 +82,11 @@ public:
     bool anyLeft(const T2 &R) const;
     template<class T2>
     bool anyRight(const T2 &L) const;
-    void clear()                        { m_Relation.clear(); }
+    void clear();
+    bool closureKept() const { return m_Nodes.size() <= m_MaxClosureNodes; }
     std::size_t depthToLeft(T t) const;
         // Return 0 for the leftmosts.
-    bool empty() const { return m_Relation.empty(); }
+    bool empty() const { return m_Edges.empty(); }
     template<class T2, class F>
     void getRelated(T2 L, F R, std::size_t maxDepth = 0) const requires std::constructible_from<T,T2> && std::invocable<F,T>;
     template<class F>
@@ -50,15 +98,50 @@ public:
     template<class F>
     void makeLinear(F apply, E_MakeLinearPolicy policy = MLP_BREADTH_FIRST) const requires std::invocable<F,T>;
     bool related(const T &a, const T &b) const;
+    template<class F>
+    C_ScheduleReport schedule(F apply, unsigned threads = 0) const requires std::invocable<F,T>;
+    template<class F, class F_Cost>
+    C_ScheduleReport schedule(F apply, F_Cost cost, unsigned threads = 0) const requires
+        std::invocable<F,T> && std::convertible_to<std::invoke_result_t<F_Cost,const T&>,double>;
 
 private:
 
+    // Types
+    typedef std::pair<std::size_t,std::size_t> C_Edge;
+    typedef std::vector<std::vector<std::size_t>> C_Adjacency;  // Edge indices by node
+
+    struct C_NoIndex {};
+    static constexpr bool HASHABLE = requires(const T &t) { std::hash<T>{}(t); };
+    typedef std::conditional_t<HASHABLE, std::unordered_map<T,std::size_t>,
+            std::conditional_t<std::totally_ordered<T>, std::map<T,std::size_t>, C_NoIndex>> C_Index;
+
     // Data
-    std::list<std::pair<T,T>>   m_Relation;
+    std::vector<T>          m_Nodes;        // In order of appearance
+    std::vector<C_Edge>     m_Edges;        // In order of addition
+    C_Adjacency             m_Out, m_In;
+    C_Index                 m_Index;
+    std::vector<std::uint64_t> m_Closure;   // Row of m_ClosureWords words per node
+    std::size_t             m_ClosureWords{};
+    std::size_t             m_MaxClosureNodes{DEF_MAX_CLOSURE_NODES};
 
     // Nonvirtuals
-    bool find(const C_ValList &src, T t) const;
-    void pruneLeftmost(C_ValList &l, const C_ValList &r) const;
+    void addToClosure(std::size_t from, std::size_t to);
+    std::uint64_t *closureOf(std::size_t node) { return m_Closure.data() + node * m_ClosureWords; }
+    const std::uint64_t *closureOf(std::size_t node) const { return m_Closure.data() + node * m_ClosureWords; }
+    template<class F>
+    void getRelated(std::vector<std::size_t> &&src, const C_Adjacency &adj, bool toRight, F dst, std::size_t maxDepth) const;
+    template<class T2>
+    std::size_t idOf(const T2 &t) const;
+    std::size_t intern(const T &t);
+    template<class F>
+    void makeLinearIds(F apply, E_MakeLinearPolicy policy) const;
+    bool reachable(std::size_t from, std::size_t to) const;
+    template<class C>
+    std::vector<std::size_t> toIds(const C &src) const;
+
+    // Class Constants
+    static constexpr std::size_t DEF_MAX_CLOSURE_NODES = 1024; // 128KiB of bitsets
+    static constexpr std::size_t NO_NODE = std::size_t(-1);
 };
 
 //
@@ -84,63 +167,114 @@ bool C_PartialOrdering<T>::addOrder(T1 a, T2 b)
     if (a == b)
         return false;
 
-    if (related(b, a))
-        // Looping
-        return false;
+    const T ta(std::move(a)), tb(std::move(b));
+    auto ia = idOf(ta), ib = idOf(tb);
+    if (ia != NO_NODE && ib != NO_NODE)
+    {
+        if (reachable(ib, ia))
+            // Looping
+            return false;
+
+        for (auto i: m_Out[ia])
+            if (m_Edges[i].second == ib)
+                // Already added
+                return true;
+    }
+    if (ia == NO_NODE)
+        ia = intern(ta);
+    if (ib == NO_NODE)
+        ib = intern(tb);
 
-    for (auto &i: m_Relation)
-        if (a == i.first && b == i.second)
-            // Already added
-            return true;
+    if (closureKept())
+        addToClosure(ia, ib);
 
-    m_Relation.emplace_back(a, b);
+    m_Out[ia].push_back(m_Edges.size());
+    m_In[ib].push_back(m_Edges.size());
+    m_Edges.emplace_back(ia, ib);
     return true;
 }
 
 template<std::equality_comparable T>
-std::size_t C_PartialOrdering<T>::depthToLeft(T t) const
+void C_PartialOrdering<T>::addToClosure(std::size_t from, std::size_t to)
+/*! Add \em to and its closure to the closures of \em from and all nodes left-related to \em from
+*/
 {
-    std::size_t ret =0;
-    for (auto &i: m_Relation)
-        if (t == i.second)
+    if (closureOf(from)[to / 64] >> to % 64 & 1)
+        // Already implied
+        return;
+
+    const auto src = closureOf(to);
+    const auto fromWord = from / 64;
+    const auto fromBit = std::uint64_t(1) << from % 64;
+    for (std::size_t i = 0; i < m_Nodes.size(); ++i)
+        if (const auto dst = closureOf(i); (i == from || dst[fromWord] & fromBit) && !(dst[to / 64] >> to % 64 & 1))
         {
-            const std::size_t cur = depthToLeft(i.first) +1;
-            if (cur > ret)
-                ret = cur;
+            for (std::size_t j = 0; j < m_ClosureWords; ++j)
+                dst[j] |= src[j];
+
+            dst[to / 64] |= std::uint64_t(1) << to % 64;
         }
-    return ret;
 }
 
 template<std::equality_comparable T>
-bool C_PartialOrdering<T>::find(const C_ValList &src, T t) const
+template<class T2>
+bool C_PartialOrdering<T>::anyLeft(const T2 &R) const
 {
-    for (auto &i: src)
-        if (t == i)
-            return true;
-
-    return false;
+    const auto id = idOf(R);
+    return id != NO_NODE && !m_In[id].empty();
 }
 
 template<std::equality_comparable T>
 template<class T2>
-bool C_PartialOrdering<T>::anyLeft(const T2 &R) const
+bool C_PartialOrdering<T>::anyRight(const T2 &L) const
 {
-    for (auto &i: m_Relation)
-        if (i.second == R)
-            return true;
+    const auto id = idOf(L);
+    return id != NO_NODE && !m_Out[id].empty();
+}
 
-    return false;
+template<std::equality_comparable T>
+void C_PartialOrdering<T>::clear()
+{
+    m_Nodes.clear();
+    m_Edges.clear();
+    m_Out.clear();
+    m_In.clear();
+    m_Closure.clear();
+    m_ClosureWords = 0;
+    if constexpr (!std::is_same_v<C_Index,C_NoIndex>)
+        m_Index.clear();
 }
 
 template<std::equality_comparable T>
-template<class T2>
-bool C_PartialOrdering<T>::anyRight(const T2 &L) const
+std::size_t C_PartialOrdering<T>::depthToLeft(T t) const
 {
-    for (auto &i: m_Relation)
-        if (L == i.first)
-            return true;
+    const auto id = idOf(t);
+    if (id == NO_NODE)
+        return 0;
+
+    // Depth-first over left-related nodes, each visited once
+    std::vector<std::size_t> depth(m_Nodes.size(), NO_NODE);
+    std::vector<std::pair<std::size_t,std::size_t>> stack{{id, 0}}; // (node, index of next in-edge)
+    while (!stack.empty())
+    {
+        const auto node = stack.back().first;
+        if (auto &next = stack.back().second; next < m_In[node].size())
+        {
+            const auto left = m_Edges[m_In[node][next++]].first;
+            if (depth[left] == NO_NODE)
+                stack.emplace_back(left, 0);
+        }
+        else
+        {
+            std::size_t ret = 0;
+            for (auto i: m_In[node])
+                ret = std::max(ret, depth[m_Edges[i].first] + 1);
 
-    return false;
+            depth[node] = ret;
+            stack.pop_back();
+        }
+    }
+    return depth[id];
 }
 
 template<std::equality_comparable T>
@@ -161,50 +295,97 @@ template<std::equality_comparable T>
 template<class F>
 void C_PartialOrdering<T>::getRelated(C_ValList L, F R, std::size_t maxDepth) const requires std::invocable<F,T>
 {
-    std::size_t oldSize = 0;
-    C_ValList dst;
+    getRelated(toIds(L), m_Out, true, R, maxDepth);
+}
+
+template<std::equality_comparable T>
+template<class F>
+void C_PartialOrdering<T>::getRelated(F L, C_ValList R, std::size_t maxDepth) const requires std::invocable<F,T>
+{
+    getRelated(toIds(R), m_In, false, L, maxDepth);
+}
+
+template<std::equality_comparable T>
+template<class F>
+void C_PartialOrdering<T>::getRelated(std::vector<std::size_t> &&src, const C_Adjacency &adj, bool toRight,
+    F dst, std::size_t maxDepth) const
+/*! Layer by layer, report nodes related to \em src in order of addition of edges to them.
+*/
+{
+    std::vector<char> added(m_Nodes.size());
+    std::vector<std::size_t> edges, found;
     for (std::size_t depth = 0; !maxDepth || depth < maxDepth; ++depth)
     {
-        for (auto &i: m_Relation)
-            for (auto &j: L)
-                if (j == i.first)
-                    addUnique(dst, i.second);
+        edges.clear();
+        for (auto i: src)
+            edges.insert(edges.end(), adj[i].begin(), adj[i].end());
 
-        if (oldSize == dst.size())
+        std::sort(edges.begin(), edges.end());
+        const auto oldSize = found.size();
+        for (auto i: edges)
+        {
+            const auto t = toRight? m_Edges[i].second: m_Edges[i].first;
+            if (!added[t])
+            {
+                added[t] = true;
+                found.push_back(t);
+            }
+        }
+        if (oldSize == found.size())
             break;
 
-        auto iDst = dst.begin();
-        std::advance(iDst, oldSize);
-        L.assign(iDst, dst.end());
-        oldSize = dst.size();
+        src.assign(found.begin() + std::ptrdiff_t(oldSize), found.end());
     }
-    for (auto &i: dst)
-        R(i);
+    for (auto i: found)
+        dst(m_Nodes[i]);
 }
 
 template<std::equality_comparable T>
-template<class F>
-void C_PartialOrdering<T>::getRelated(F L, C_ValList R, std::size_t maxDepth) const requires std::invocable<F,T>
+template<class T2>
+std::size_t C_PartialOrdering<T>::idOf(const T2 &t) const
 {
-    std::size_t oldSize = 0;
-    C_ValList dst;
-    for (std::size_t depth = 0; !maxDepth || depth < maxDepth; ++depth)
+    if constexpr (!std::is_same_v<C_Index,C_NoIndex> && std::constructible_from<T,const T2&>)
+    {
+        const auto found = m_Index.find(T(t));
+        return found != m_Index.end()? found->second: NO_NODE;
+    }
+    else
     {
-        for (auto &i: m_Relation)
-            for (auto &j: R)
-                if (j == i.second)
-                    addUnique(dst, i.first);
+        for (std::size_t i = 0; i < m_Nodes.size(); ++i)
+            if (m_Nodes[i] == t)
+                return i;
 
-        if (oldSize == dst.size())
-            break;
+        return NO_NODE;
+    }
+}
 
-        auto iDst = dst.begin();
-        std::advance(iDst, oldSize);
-        R.assign(iDst, dst.end());
-        oldSize = dst.size();
+template<std::equality_comparable T>
+std::size_t C_PartialOrdering<T>::intern(const T &t)
+{
+    const auto ret = m_Nodes.size();
+    if constexpr (!std::is_same_v<C_Index,C_NoIndex>)
+        m_Index.emplace(t, ret);
+
+    m_Nodes.push_back(t);
+    m_Out.emplace_back();
+    m_In.emplace_back();
+    if (!closureKept())
+        std::vector<std::uint64_t>{}.swap(m_Closure);
+    else if (const auto words = ret / 64 + 1; words > m_ClosureWords)
+    {
+        // Widen the rows
+        const auto newWords = std::max(words, m_ClosureWords * 2);
+        std::vector<std::uint64_t> closure(newWords * m_Nodes.size());
+        for (std::size_t i = 0; i < ret; ++i)
+            std::copy_n(closureOf(i), m_ClosureWords, closure.data() + i * newWords);
+
+        m_Closure.swap(closure);
+        m_ClosureWords = newWords;
     }
-    for (auto &i: dst)
-        L(i);
+    else
+        m_Closure.resize(m_ClosureWords * m_Nodes.size());
+
+    return ret;
 }
 
 template<std::equality_comparable T>
@@ -233,78 +414,251 @@ void C_PartialOrdering<T>::makeLinear(F apply, E_MakeLinearPolicy policy) const
     it means the graph has at least one cycle and therefore is not a
     <a href="http://en.wikipedia.org/wiki/Directed_acyclic_graph" target="_blank">DAG</a>,
     so the algorithm can report an error.
+
+    Edges are "removed" by counting down the in-degrees.
 */
-    C_ValList   q, r;
-    auto        mapping = m_Relation;
-    for (auto &i: mapping)
-    {
-        addUnique(q, i.first);
-        addUnique(r, i.second);
-    }
-    pruneLeftmost(q, r);
+    makeLinearIds([&](std::size_t i) { apply(m_Nodes[i]); }, policy);
+}
 
+template<std::equality_comparable T>
+template<class F>
+void C_PartialOrdering<T>::makeLinearIds(F apply, E_MakeLinearPolicy policy) const
+{
+    std::vector<std::size_t> inDegree(m_Nodes.size());
+    std::deque<std::size_t> q;
+    for (std::size_t i = 0; i < m_Nodes.size(); ++i)
+        if (!(inDegree[i] = m_In[i].size()))
+            q.push_back(i);
+
+    std::vector<std::size_t> l;
     while (!q.empty())
     {
-        const T t =q.front();
+        const auto t = q.front();
         q.pop_front();
         apply(t);
 
-        C_ValList l;
-        r.clear();
-        for (auto i = mapping.begin(), end = mapping.end(); i != end;)
-        {
-            if (t == i->first)
-            {
-                addUnique(l, i->second);
-                i = mapping.erase(i);
-            }
-            else
-            {
-                addUnique(r, i->second);
-                ++i;
-            }
-        }
+        l.clear();
+        for (auto i: m_Out[t])
+            if (const auto m = m_Edges[i].second; !--inDegree[m])
+                l.push_back(m);
 
-        pruneLeftmost(l, r);
         switch (policy)
         {
         case MLP_BREADTH_FIRST:
-            q.splice(q.end(), l);
+            q.insert(q.end(), l.begin(), l.end());
             break;
         case MLP_DEPTH_FIRST:
-            q.splice(q.begin(), l);
+            q.insert(q.begin(), l.begin(), l.end());
             break;
         }
     }
 }
 
 template<std::equality_comparable T>
-void C_PartialOrdering<T>::pruneLeftmost(C_ValList &l, const C_ValList &r) const
+bool C_PartialOrdering<T>::reachable(std::size_t from, std::size_t to) const
+/*! Look up the closure if kept, or else search depth-first, visiting each node at most once
+*/
 {
-    for (auto i = l.begin(), end = l.end(); i != end;)
+    if (from == to)
+        // Irreflexive
+        return false;
+
+    if (closureKept())
+        return closureOf(from)[to / 64] >> to % 64 & 1;
+
+    std::vector<char> visited(m_Nodes.size());
+    std::vector<std::size_t> stack{from};
+    visited[from] = true;
+    while (!stack.empty())
     {
-        if (find(r, *i))
-            i = l.erase(i);
-        else
-            ++i;
+        const auto t = stack.back();
+        stack.pop_back();
+        for (auto i: m_Out[t])
+        {
+            const auto m = m_Edges[i].second;
+            if (m == to)
+                return true;
+
+            if (!visited[m])
+            {
+                visited[m] = true;
+                stack.push_back(m);
+            }
+        }
     }
+    return false;
 }
 
 template<std::equality_comparable T>
 bool C_PartialOrdering<T>::related(const T &a, const T &b) const
 {
-    for (auto &i: m_Relation)
-        if (a == i.first)
+    const auto ia = idOf(a), ib = idOf(b);
+    return ia != NO_NODE && ib != NO_NODE && reachable(ia, ib);
+}
+
+template<std::equality_comparable T>
+template<class F>
+C_ScheduleReport C_PartialOrdering<T>::schedule(F apply, unsigned threads) const requires std::invocable<F,T>
+{
+    return schedule(apply, [](const T&) { return 1.; }, threads);
+}
+
+template<std::equality_comparable T>
+template<class F, class F_Cost>
+C_ScheduleReport C_PartialOrdering<T>::schedule(F apply, F_Cost cost, unsigned threads) const requires
+    std::invocable<F,T> && std::convertible_to<std::invoke_result_t<F_Cost,const T&>,double>
+/*! \param [in] apply Node visitor, called concurrently for nodes not related to each other.
+    \param [in] cost Hint of how long it takes to apply a node, in any unit.
+    \param [in] threads Number of threads to apply nodes; 0 for std::thread::hardware_concurrency()
+
+    Each node is applied as soon as all its left-related nodes are done. Among the nodes ready to
+    go, those heading the costliest chains of right-related nodes go first, and then the earliest
+    added. Each thread picks from its own ready nodes, or steals from other threads when it has none.
+
+    If \em apply throws, no more nodes are applied and the first exception is rethrown when all
+    threads are done.
+*/
+{
+    typedef std::chrono::steady_clock C_Clock;
+    C_ScheduleReport ret;
+    const auto n = ret.m_nodes = m_Nodes.size();
+
+    // Cost of the costliest chain from each node, by reverse topological order
+    std::vector<std::size_t> order;
+    order.reserve(n);
+    makeLinearIds([&](std::size_t i) { order.push_back(i); }, MLP_BREADTH_FIRST);
+    std::vector<double> priority(n);
+    for (auto i = order.rbegin(); i != order.rend(); ++i)
+    {
+        const double c = cost(m_Nodes[*i]);
+        ret.m_totalCost += c;
+        double next{};
+        for (auto j: m_Out[*i])
+            next = std::max(next, priority[m_Edges[j].second]);
+
+        priority[*i] = c + next;
+        ret.m_criticalPath = std::max(ret.m_criticalPath, priority[*i]);
+    }
+
+    if (!threads)
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    ret.m_threads = unsigned(std::max<std::size_t>(std::min<std::size_t>(threads, n), 1));
+
+    struct C_ReadyQueue
+    {
+        std::mutex                  m_lock;
+        std::vector<std::size_t>    m_heap;
+    };
+    std::vector<C_ReadyQueue> queues(ret.m_threads);
+    const auto higher = [&](std::size_t a, std::size_t b) { return priority[a] < priority[b] || (priority[a] == priority[b] && a > b); };
+    const auto push = [&](C_ReadyQueue &q, std::size_t node) {
+        std::scoped_lock _{q.m_lock};
+        q.m_heap.push_back(node);
+        std::push_heap(q.m_heap.begin(), q.m_heap.end(), higher);
+    };
+    const auto pop = [&](C_ReadyQueue &q) {
+        std::scoped_lock _{q.m_lock};
+        if (q.m_heap.empty())
+            return NO_NODE;
+
+        std::pop_heap(q.m_heap.begin(), q.m_heap.end(), higher);
+        const auto node = q.m_heap.back();
+        q.m_heap.pop_back();
+        return node;
+    };
+
+    std::vector<std::atomic<std::size_t>> pending(n);
+    std::size_t seeded{};
+    for (std::size_t i = 0; i < n; ++i)
+        if (!(pending[i] = m_In[i].size()))
+            push(queues[seeded++ % ret.m_threads], i);
+
+    std::atomic<std::size_t>    done{0};
+    std::atomic<unsigned>       epoch{0};   // Bumped whenever nodes get ready or all is over
+    std::atomic<bool>           stop{false};
+    std::atomic<std::size_t>    steals{0};
+    std::atomic<C_Clock::rep>   busy{0};
+    std::exception_ptr          error;
+    std::mutex                  errorLock;
+    const auto work = [&](unsigned self) {
+        std::size_t stolen{};
+        C_Clock::duration elapsed{};
+        while (!stop && done < n)
         {
-            if (i.second == b)
-                // aRb
-                return true;
+            const auto seen = epoch.load();
+            auto node = pop(queues[self]);
+            for (unsigned i = 1; node == NO_NODE && i < ret.m_threads; ++i)
+                if ((node = pop(queues[(self + i) % ret.m_threads])) != NO_NODE)
+                    ++stolen;
 
-            if (related(i.second, b))
-                // aRt && tRb
-                return true;
+            if (node == NO_NODE)
+            {
+                epoch.wait(seen);
+                continue;
+            }
+            const auto start = C_Clock::now();
+            try
+            {
+                apply(m_Nodes[node]);
+            }
+            catch (...)
+            {
+                std::scoped_lock _{errorLock};
+                if (!error)
+                    error = std::current_exception();
+                stop = true;
+            }
+            elapsed += C_Clock::now() - start;
+
+            bool readied{};
+            for (auto i: m_Out[node])
+                if (const auto m = m_Edges[i].second; pending[m].fetch_sub(1) == 1)
+                {
+                    push(queues[self], m);
+                    readied = true;
+                }
+            if (++done == n || readied || stop)
+            {
+                ++epoch;
+                epoch.notify_all();
+            }
         }
-    return false;
+        steals += stolen;
+        busy += elapsed.count();
+    };
+
+    const auto start = C_Clock::now();
+    if (ret.m_threads > 1)
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(ret.m_threads);
+        for (unsigned i = 0; i < ret.m_threads; ++i)
+            workers.emplace_back(work, i);
+    }
+    else
+        work(0);
+
+    ret.m_wallTime = C_Clock::now() - start;
+    ret.m_busyTime = C_Clock::duration{busy.load()};
+    ret.m_steals = steals;
+    if (error)
+        std::rethrow_exception(error);
+
+    return ret;
+}
+
+template<std::equality_comparable T>
+template<class C>
+std::vector<std::size_t> C_PartialOrdering<T>::toIds(const C &src) const
+{
+    std::vector<std::size_t> ret;
+    for (auto &i: src)
+        if (const auto id = idOf(i); id != NO_NODE)
+            ret.push_back(id);
+
+    std::sort(ret.begin(), ret.end());
+    ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+    return ret;
 }
 
 } // namespace bux
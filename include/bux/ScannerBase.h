@@ -148,9 +148,8 @@ template<T_LexID _ID, class T_LexCh, size_t TRIMLEFT = 0, size_t TRIMRIGHT = 0>
 }
 
 template<class T_Char>
-void scanFile(std::string_view filename, std::istream &in, I_Scanner<T_Char> &scanner, T_LexID endToken = TID_EOF, T_Encoding encoding = 0)
+void scanFile(std::string_view filename, C_UnicodeIn &src, I_Scanner<T_Char> &scanner, T_LexID endToken = TID_EOF)
 {
-    C_UnicodeIn     src(in, encoding);
     unsigned        line = 1, col = 1;
     T_Char          c;
 
@@ -179,4 +178,11 @@ void scanFile(std::string_view filename, std::istream &in, I_Scanner<T_Char> &sc
     scanner.add(col, c);
 }
 
+template<class T_Char>
+void scanFile(std::string_view filename, std::istream &in, I_Scanner<T_Char> &scanner, T_LexID endToken = TID_EOF, T_Encoding encoding = 0)
+{
+    C_UnicodeIn     src(in, encoding);
+    scanFile(filename, src, scanner, endToken);
+}
+
 } //namespace bux
@@ -1,30 +1,192 @@
+#pragma once
+
+#include <algorithm>    // std::min()
 #include <array>        // std::array<>
+#include <bit>          // std::bit_cast<>, std::byteswap(), std::endian
+#include <cstddef>      // std::byte
+#include <cstdint>      // std::uint8_t, std::uint32_t, std::uint64_t, std::int64_t, std::uintptr_t
 #include <cstring>      // memcpy()
 #include <iosfwd>       // Forwarded std::istream, std::ostream
+#include <iterator>     // std::size(), std::make_move_iterator()
+#include <span>         // std::span<>, std::as_bytes()
+#include <stdexcept>    // std::out_of_range, std::runtime_error
 #include <string>       // std::string
+#include <string_view>  // std::string_view
 #include <tuple>        // std::tuple<>
-#include <type_traits>  // std::is_standard_layout_v<>
+#include <type_traits>  // std::is_standard_layout_v<>, std::is_arithmetic_v<>, std::is_enum_v<>, ...
+#include <utility>      // std::move()
 
 namespace bux {
 
+//
+//      Types
+//
+template<class T>
+concept ByteSink = requires(T &dst, const char *src, size_t bytes) {
+    dst.append(src, bytes);
+};  ///< std::string, bux::C_OFileAsMemory, ...
+
+template<class T>
+concept BinScalar = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+    ///< Types stored as fixed-size little-endian by append_le() and read back by C_BinReader::readLE()
+
+class C_BinReader
+/*! Bounds-checked cursor over serialized bytes, e.g. bux::C_FileAsMemory::bytes(), to read back
+    what is written by append_le(), append_varint(), append_zigzag(), append_blob(), append_seq()
+    and append_tag(). Values are loaded with memcpy() so the source needn't be aligned. Arrays written by
+    append_array() are viewed in place, which is where the source alignment does matter.
+
+    All reading methods throw std::out_of_range when running past the end without moving the cursor.
+*/
+{
+public:
+
+    // Nonvirtuals
+    explicit C_BinReader(std::span<const std::byte> src) noexcept: m_src(src) {}
+    explicit C_BinReader(std::span<const char> src) noexcept: m_src(std::as_bytes(src)) {}
+    void align(size_t alignment);
+        ///< Skip padding up to the next offset which is a multiple of \em alignment
+    bool empty() const noexcept     { return m_pos == m_src.size(); }
+    auto offset() const noexcept    { return m_pos; }
+    auto remaining() const noexcept { return m_src.size() - m_pos; }
+    template<class T> std::span<const T> readArray();
+        ///< Array written by append_array(), viewed in place
+    std::string_view readBlob();
+        ///< Length-prefixed bytes written by append_blob(), viewed in place
+    template<BinScalar T> T readLE();
+    template<class C> void readSeq(C &dst);
+        ///< Append to \em dst elements written by append_seq()
+    template<class C, class F> void readSeq(C &dst, F readElem);
+        ///< Append to \em dst elements read by <tt>readElem(*this)</tt>
+    std::uint32_t readTag(std::uint32_t magic, std::uint32_t maxVersion);
+        ///< Return the version written by append_tag() if the magic matches and the version isn't newer than \em maxVersion
+    std::uint64_t readVarint();
+    std::string_view readView(size_t bytes);
+        ///< View the next \em bytes in place as characters
+    std::int64_t readZigzag();
+    void skip(size_t bytes)         { take(bytes); }
+    std::span<const std::byte> take(size_t bytes);
+        ///< View the next \em bytes in place and move past them
+
+private:
+
+    // Data
+    std::span<const std::byte>  m_src;
+    size_t                      m_pos{};
+};
+
 //
 //      Functions
 //
 template<class T>
-void append(const T &src, std::string &dst)
+void append(const T &src, ByteSink auto &dst)
 {
     static_assert(std::is_standard_layout_v<T>);
     dst.append(reinterpret_cast<const char*>(&src), sizeof src);
 }
 
+template<BinScalar T>
+void append_le(T src, ByteSink auto &dst)
+/*! Append \em src as fixed-size little-endian bytes, the same on any host.
+*/
+{
+    if constexpr (std::is_enum_v<T>)
+        append_le(std::underlying_type_t<T>(src), dst);
+    else if constexpr (sizeof(T) == 1)
+        dst.append(reinterpret_cast<const char*>(&src), 1);
+    else
+    {
+        using U = std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                  std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>;
+        static_assert(sizeof(T) == sizeof(U));
+        auto u = std::bit_cast<U>(src);
+        if constexpr (std::endian::native == std::endian::big)
+            u = std::byteswap(u);
+        dst.append(reinterpret_cast<const char*>(&u), sizeof u);
+    }
+}
+
+void append_varint(std::uint64_t src, ByteSink auto &dst)
+/*! Append \em src in LEB128, i.e. 7 bits a byte with the high bit telling if more bytes follow.
+*/
+{
+    char buf[10];
+    size_t n = 0;
+    for (; src >= 0x80; src >>= 7)
+        buf[n++] = char(src | 0x80);
+    buf[n++] = char(src);
+    dst.append(buf, n);
+}
+
+void append_zigzag(std::int64_t src, ByteSink auto &dst)
+/*! Append signed \em src as varint with small magnitudes, negative or not, taking few bytes.
+*/
+{
+    append_varint((std::uint64_t(src) << 1) ^ std::uint64_t(src >> 63), dst);
+}
+
+void append_blob(std::string_view src, ByteSink auto &dst)
+{
+    append_varint(src.size(), dst);
+    dst.append(src.data(), src.size());
+}
+
+template<class C, class F>
+void append_seq(const C &src, ByteSink auto &dst, F appendElem)
+/*! Append varint count of \em src followed by each element by <tt>appendElem(elem, dst)</tt>
+*/
+{
+    append_varint(std::size(src), dst);
+    for (auto &i: src)
+        appendElem(i, dst);
+}
+
+template<class C>
+void append_seq(const C &src, ByteSink auto &dst)
+/*! Append varint count of \em src followed by its elements, which are either of BinScalar or strings.
+*/
+{
+    append_seq(src, dst, [](const auto &i, auto &out) {
+        if constexpr (BinScalar<std::remove_cvref_t<decltype(i)>>)
+            append_le(i, out);
+        else
+            append_blob(i, out);
+    });
+}
+
+void append_tag(std::uint32_t magic, std::uint32_t version, ByteSink auto &dst)
+/*! Mark the start of versioned data, to be checked by C_BinReader::readTag()
+*/
+{
+    append_le(magic, dst);
+    append_varint(version, dst);
+}
+
+template<class T, size_t N>
+void append_array(std::span<const T,N> src, ByteSink auto &dst) requires requires { dst.size(); }
+/*! Append varint count of \em src followed by its elements as they are in memory, padded to be
+    properly aligned, so that C_BinReader::readArray() can view them in place without copying.
+    Unlike append_le(), the layout is native to the host.
+*/
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    append_varint(src.size(), dst);
+    if (const auto misalign = dst.size() % alignof(T))
+    {
+        static constexpr char ZEROS[alignof(T)]{};
+        dst.append(ZEROS, alignof(T) - misalign);
+    }
+    dst.append(reinterpret_cast<const char*>(src.data()), src.size_bytes());
+}
+
 template<class T>
-void append_size_of(const T &src, std::string &dst)
+void append_size_of(const T &src, ByteSink auto &dst)
 {
     append(std::size(src), dst);
 }
 
 template<class T>
-void append(const T *src, size_t argN, std::string &dst)
+void append(const T *src, size_t argN, ByteSink auto &dst)
 {
     static_assert(std::is_standard_layout_v<T>);
     static_assert(sizeof(T[10]) == sizeof(T) * 10);
@@ -39,6 +201,21 @@ void read(const std::string &src, size_t &off, T &data) noexcept
     off += sizeof data;
 }
 
+template<class T>
+void read(std::span<const char> src, size_t &off, T &data)
+/*! Same as the overload of std::string, but reads from anywhere e.g. C_FileAsMemory::span() and
+    throws std::out_of_range instead of reading past the end.
+*/
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    C_BinReader in{src};
+    in.skip(off);
+    memcpy(&data, in.take(sizeof data).data(), sizeof data);
+    off += sizeof data;
+}
+
+std::string_view read_view(std::span<const char> src, size_t &off, size_t bytes);
+
 size_t read_size(const std::string &src, size_t &off) noexcept;
 
 template<class T>
@@ -66,18 +243,18 @@ std::array<char,N> read_charr(const std::string &src, size_t &off) noexcept
 }
 
 template<size_t N, template<typename> class C>
-void append(const C<std::array<char,N>> &src, std::string &dst)
+void append(const C<std::array<char,N>> &src, ByteSink auto &dst)
 {
     append_size_of(src, dst);
     if constexpr (N <= 8)
     {
         for (auto i: src)
-            dst += to_str(i);
+            dst.append(i.data(), N);
     }
     else
     {
         for (auto &i: src)
-            dst += to_str(i);
+            dst.append(i.data(), N);
     }
 }
 
@@ -91,4 +268,89 @@ void read(const std::string &src, size_t &off, C<std::array<char,N>> &data)
 std::tuple<std::string,size_t,bool> load_hashed_str(std::istream &in);
 size_t save_hashed_str(std::ostream &out, const std::string &s);
 
+//
+//      Implement Class Templates
+//
+template<BinScalar T>
+T C_BinReader::readLE()
+{
+    if constexpr (std::is_enum_v<T>)
+        return T(readLE<std::underlying_type_t<T>>());
+    else
+    {
+        using U = std::conditional_t<sizeof(T) == 1, std::uint8_t,
+                  std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                  std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+        static_assert(sizeof(T) == sizeof(U));
+        U u;
+        memcpy(&u, take(sizeof u).data(), sizeof u);
+        if constexpr (std::endian::native == std::endian::big && sizeof u > 1)
+            u = std::byteswap(u);
+        return std::bit_cast<T>(u);
+    }
+}
+
+template<class T>
+std::span<const T> C_BinReader::readArray()
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    const auto pos = m_pos;
+    try
+    {
+        const auto n = readVarint();
+        align(alignof(T));
+        if (n > remaining() / sizeof(T))
+            throw std::out_of_range{"Array of " + std::to_string(n) + " elements passes the end"};
+
+        const auto bytes = take(size_t(n) * sizeof(T));
+        if (reinterpret_cast<std::uintptr_t>(bytes.data()) % alignof(T))
+            throw std::runtime_error{"Misaligned source to view array in place"};
+
+        return {reinterpret_cast<const T*>(bytes.data()), size_t(n)};
+    }
+    catch (...)
+    {
+        m_pos = pos;
+        throw;
+    }
+}
+
+template<class C>
+void C_BinReader::readSeq(C &dst)
+{
+    using T = typename C::value_type;
+    readSeq(dst, [](C_BinReader &src) {
+        if constexpr (BinScalar<T>)
+            return src.readLE<T>();
+        else
+            return T{src.readBlob()};
+    });
+}
+
+template<class C, class F>
+void C_BinReader::readSeq(C &dst, F readElem)
+{
+    // Read into a temporary so that failure leaves both dst and the cursor untouched
+    const auto pos = m_pos;
+    C t;
+    try
+    {
+        const auto n = readVarint();
+        if constexpr (requires { t.reserve(size_t(n)); })
+            // Not trusting the count to reserve beyond what could possibly be read
+            t.reserve(size_t(std::min<std::uint64_t>(n, remaining())));
+        for (auto i = n; i; --i)
+            t.insert(t.end(), readElem(*this));
+    }
+    catch (...)
+    {
+        m_pos = pos;
+        throw;
+    }
+    if (dst.empty())
+        dst = std::move(t);
+    else
+        dst.insert(dst.end(), std::make_move_iterator(t.begin()), std::make_move_iterator(t.end()));
+}
+
 } // namespace bux
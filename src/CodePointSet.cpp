@@ -0,0 +1,97 @@
+#include "CodePointSet.h"
+#include <bit>          // std::countr_one(), std::countr_zero()
+#include <map>          // std::map<>
+#include <unordered_map>// std::unordered_map<>
+
+namespace {
+
+//
+//      In-Module Constants
+//
+constexpr std::size_t TOTAL_WORDS = (bux::C_CodePointSet::MAX_CODE_POINT + 1) / 64;
+constexpr std::size_t WORDS_PER_BLOCK = 128;
+
+} // namespace
+
+namespace bux {
+
+//
+//      Implement Classes
+//
+void C_CodePointSet::build(const std::vector<C_Range> &ranges)
+{
+    // Flat bitmap of the whole code space
+    std::vector<std::uint64_t> words(TOTAL_WORDS);
+    for (auto &i: ranges)
+        for (auto c = i.first; c <= i.second;)
+        {
+            const auto bit = c & 63;
+            const auto n = std::min<std::uint32_t>(64 - bit, i.second - c + 1);
+            words[c >> 6] |= (n < 64? (std::uint64_t(1) << n) - 1: ~std::uint64_t()) << bit;
+            c += n;
+        }
+
+    m_Ascii[0] = words[0];
+    m_Ascii[1] = words[1];
+
+    // Share identical words, and then identical blocks
+    m_Leaves.assign(1, 0);
+    std::unordered_map<std::uint64_t,std::uint16_t> leafIds{{0, 0}};
+    std::map<std::vector<std::uint16_t>,std::uint16_t> blockIds;
+    m_Blocks.clear();
+    std::vector<std::uint16_t> block(WORDS_PER_BLOCK);
+    for (std::size_t b = 0; b < m_Top.size(); ++b)
+    {
+        for (std::size_t i = 0; i < WORDS_PER_BLOCK; ++i)
+        {
+            const auto w = words[b * WORDS_PER_BLOCK + i];
+            const auto found = leafIds.try_emplace(w, std::uint16_t(m_Leaves.size())).first;
+            if (found->second == m_Leaves.size())
+                m_Leaves.push_back(w);
+
+            block[i] = found->second;
+        }
+        const auto found = blockIds.try_emplace(block, std::uint16_t(blockIds.size())).first;
+        if (found->second * WORDS_PER_BLOCK == m_Blocks.size())
+            m_Blocks.insert(m_Blocks.end(), block.begin(), block.end());
+
+        m_Top[b] = found->second;
+    }
+    m_Blocks.shrink_to_fit();
+    m_Leaves.shrink_to_fit();
+}
+
+std::size_t C_CodePointSet::bytes() const noexcept
+{
+    return sizeof *this + m_Blocks.capacity() * sizeof m_Blocks[0] + m_Leaves.capacity() * sizeof m_Leaves[0];
+}
+
+C_Intervals<std::uint32_t> C_CodePointSet::toIntervals() const
+{
+    std::vector<C_Intervals<std::uint32_t>::value_type> dst;
+    bool inRange = false;
+    for (std::uint32_t w = 0; w < TOTAL_WORDS; ++w)
+    {
+        const auto bits = m_Leaves[m_Blocks[std::size_t(m_Top[w >> 7]) << 7 | (w & 127)]];
+        for (std::uint32_t bit = 0;;)
+        {
+            // Length of the current run of ones if in range, or else of zeros
+            const auto rest = bits >> bit;
+            const auto n = std::uint32_t(inRange? std::countr_one(rest): std::countr_zero(rest));
+            if (bit + n >= 64)
+                // Run goes on to the next word
+                break;
+
+            bit += n;
+            if (inRange)
+                dst.back().second = w * 64 + bit - 1;
+            else
+                dst.emplace_back(w * 64 + bit, MAX_CODE_POINT);
+
+            inRange = !inRange;
+        }
+    }
+    return C_Intervals<std::uint32_t>(dst.begin(), dst.end());
+}
+
+} // namespace bux
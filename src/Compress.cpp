@@ -0,0 +1,352 @@
+#include "Compress.h"
+#include "Hash64.h"     // bux::hash64()
+#include "Serialize.h"  // bux::append_le(), bux::C_BinReader
+#include <algorithm>    // std::max(), std::min()
+#include <atomic>       // std::atomic<>
+#include <cstdint>      // std::uint16_t, std::uint32_t, std::uint64_t
+#include <cstring>      // memcpy()
+#include <istream>      // std::istream
+#include <ostream>      // std::ostream
+#include <limits>       // std::numeric_limits<>
+#include <span>         // std::span<>, std::as_bytes()
+#include <stdexcept>    // std::invalid_argument
+#include <thread>       // std::jthread, std::thread::hardware_concurrency()
+#include <vector>       // std::vector<>
+
+namespace {
+
+//
+//      In-Module Constants
+//
+constexpr std::uint32_t COMPRESSED_STR_MAGIC    = 0x7A585542;   // "BUXz" in little endian
+constexpr std::uint32_t COMPRESSED_STR_VERSION  = 1;
+constexpr size_t        HEADER_BYTES            = 4 + 4 + 8 + 4 + 4;    // Magic, version, size, block size, block count
+constexpr size_t        BLOCK_ENTRY_BYTES       = 4 + 8;                // Stored size, hash
+constexpr std::uint32_t STORED_RAW              = 0x8000'0000;          // Flag of block not worth compressing
+
+constexpr int           HASH_BITS       = 16;
+constexpr size_t        MIN_MATCH       = 4;
+constexpr size_t        LAST_LITERALS   = 5;    // Input end is always literals so that match extension needn't check bounds
+constexpr size_t        MF_LIMIT        = 12;   // No match starts within this distance to the end
+constexpr size_t        MAX_OFFSET      = 0xFFFF;
+constexpr size_t        MAX_RATIO       = 255;  // Each length byte of 255 expands to no more than 255 bytes
+constexpr size_t        READ_CHUNK      = 1 << 20;
+
+//
+//      In-Module Functions
+//
+inline std::uint32_t load32(const char *p) noexcept
+{
+    std::uint32_t ret;
+    memcpy(&ret, p, sizeof ret);
+    return ret;
+}
+
+inline size_t hashOf(std::uint32_t seq) noexcept
+{
+    return (seq * 2654435761U) >> (32 - HASH_BITS);
+}
+
+void appendLength(std::string &dst, size_t len)
+{
+    for (; len >= 255; len -= 255)
+        dst += char(255);
+    dst += char(len);
+}
+
+void appendSequence(std::string &dst, const char *lit, size_t litLen, size_t offset, size_t matchLen)
+{
+    const auto m = matchLen? matchLen - MIN_MATCH: 0;
+    dst += char((std::min<size_t>(litLen, 15) << 4) | std::min<size_t>(m, 15));
+    if (litLen >= 15)
+        appendLength(dst, litLen - 15);
+    dst.append(lit, litLen);
+    if (matchLen)
+    {
+        dst += char(offset & 0xFF);
+        dst += char(offset >> 8);
+        if (m >= 15)
+            appendLength(dst, m - 15);
+    }
+}
+
+bool readLength(const unsigned char *&ip, const unsigned char *end, size_t &len) noexcept
+{
+    for (unsigned c = 255; c == 255;)
+    {
+        if (ip == end)
+            return false;
+        c = *ip++;
+        len += c;
+    }
+    return true;
+}
+
+bool readChunked(std::istream &in, std::string &dst, std::uint64_t bytes)
+/*! Grow \em dst by chunks rather than trusting \em bytes to allocate it all at once
+*/
+{
+    dst.clear();
+    for (auto left = bytes; left;)
+    {
+        const auto n = size_t(std::min<std::uint64_t>(left, READ_CHUNK));
+        const auto off = dst.size();
+        dst.resize(off + n);
+        if (!in.read(dst.data() + off, std::streamsize(n)))
+            return false;
+
+        left -= n;
+    }
+    return true;
+}
+
+unsigned threadCount(unsigned threads, size_t jobs)
+{
+    if (!threads)
+        threads = std::max(std::thread::hardware_concurrency(), 1U);
+    return unsigned(std::min<size_t>(threads, jobs));
+}
+
+template<class F>
+void forEachJob(size_t jobs, unsigned threads, F job)
+{
+    std::atomic<size_t> next{0};
+    const auto work = [&]{
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < jobs;)
+            job(i);
+    };
+    if ((threads = threadCount(threads, jobs)) > 1)
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(threads);
+        for (unsigned i = 0; i < threads; ++i)
+            workers.emplace_back(work);
+    }
+    else
+        work();
+}
+
+} // namespace
+
+namespace bux {
+
+//
+//      Implement Functions
+//
+std::string lz_compress(std::string_view src)
+/*! Compress \em src as one block of LZ77 sequences in the spirit of LZ4: a token byte of literal & match
+    lengths, the literals, then a 16-bit match offset. Favoring speed over ratio, esp. for decompression.
+*/
+{
+    std::string ret;
+    ret.reserve(src.size() + src.size() / 255 + 16);
+    const auto base = src.data();
+    const auto n = src.size();
+    size_t anchor = 0;
+    if (n > MF_LIMIT)
+    {
+        std::vector<std::uint32_t> table(size_t(1) << HASH_BITS);
+        const auto mfLimit = n - MF_LIMIT;
+        const auto matchLimit = n - LAST_LITERALS;
+        for (size_t ip = 0; ip < mfLimit;)
+        {
+            const auto seq = load32(base + ip);
+            auto &slot = table[hashOf(seq)];
+            const size_t ref = slot;
+            slot = std::uint32_t(ip);
+            if (ref < ip && ip - ref <= MAX_OFFSET && load32(base + ref) == seq)
+            {
+                auto len = MIN_MATCH;
+                while (ip + len < matchLimit && base[ref + len] == base[ip + len])
+                    ++len;
+
+                appendSequence(ret, base + anchor, ip - anchor, ip - ref, len);
+                ip += len;
+                anchor = ip;
+            }
+            else
+                // Skip faster through incompressible data
+                ip += 1 + ((ip - anchor) >> 6);
+        }
+    }
+    appendSequence(ret, base + anchor, n - anchor, 0, 0);
+    return ret;
+}
+
+bool lz_decompress(std::string_view src, char *dst, size_t dstBytes) noexcept
+/*! \param [in] src Output of lz_compress()
+    \param [out] dst Buffer of exactly the original size
+    \param [in] dstBytes The original size
+    \return false if \em src is corrupt, which never makes it read or write out of bounds.
+*/
+{
+    auto ip = reinterpret_cast<const unsigned char*>(src.data());
+    const auto end = ip + src.size();
+    size_t op = 0;
+    while (ip < end)
+    {
+        const unsigned token = *ip++;
+        size_t litLen = token >> 4;
+        if (litLen == 15 && !readLength(ip, end, litLen))
+            return false;
+        if (litLen > size_t(end - ip) || litLen > dstBytes - op)
+            return false;
+
+        memcpy(dst + op, ip, litLen);
+        ip += litLen;
+        op += litLen;
+        if (ip == end)
+            // The last sequence has no match
+            return op == dstBytes;
+
+        if (end - ip < 2)
+            return false;
+
+        const size_t offset = ip[0] | size_t(ip[1]) << 8;
+        ip += 2;
+        size_t matchLen = token & 15;
+        if (matchLen == 15 && !readLength(ip, end, matchLen))
+            return false;
+
+        matchLen += MIN_MATCH;
+        if (!offset || offset > op || matchLen > dstBytes - op)
+            return false;
+
+        const auto from = dst + op - offset;
+        if (offset >= matchLen)
+            memcpy(dst + op, from, matchLen);
+        else
+            for (size_t i = 0; i < matchLen; ++i)
+                // Overlapped copy repeats the last offset bytes
+                dst[op + i] = from[i];
+        op += matchLen;
+    }
+    return false;
+}
+
+size_t save_compressed_str(std::ostream &out, std::string_view s, size_t blockBytes, unsigned threads)
+/*! Save \em s cut into blocks, each compressed by lz_compress() and checksummed by hash64().
+    \param [in] threads Number of threads to compress blocks; 0 for std::thread::hardware_concurrency()
+    \return Bytes written
+    \throw std::invalid_argument if \em s is cut into more blocks than the header can count
+*/
+{
+    blockBytes = std::clamp<size_t>(blockBytes, 1, STORED_RAW - 1);
+    const size_t blocks = s.size() / blockBytes + (s.size() % blockBytes != 0);
+    if (blocks > std::numeric_limits<std::uint32_t>::max())
+        throw std::invalid_argument{"Too many blocks " + std::to_string(blocks)};
+
+    std::vector<std::string> packed(blocks);
+    std::vector<std::uint64_t> hashes(blocks);
+    forEachJob(blocks, threads, [&](size_t i) {
+        const auto block = s.substr(i * blockBytes, blockBytes);
+        hashes[i] = hash64(block);
+        packed[i] = lz_compress(block);
+        if (packed[i].size() >= block.size())
+            packed[i].clear();
+    });
+
+    std::string head;
+    head.reserve(HEADER_BYTES + blocks * BLOCK_ENTRY_BYTES);
+    append_le(COMPRESSED_STR_MAGIC, head);
+    append_le(COMPRESSED_STR_VERSION, head);
+    append_le(std::uint64_t(s.size()), head);
+    append_le(std::uint32_t(blockBytes), head);
+    append_le(std::uint32_t(blocks), head);
+    for (size_t i = 0; i < blocks; ++i)
+    {
+        const auto &p = packed[i];
+        append_le(p.empty()? std::uint32_t(std::min(blockBytes, s.size() - i * blockBytes)) | STORED_RAW: std::uint32_t(p.size()), head);
+        append_le(hashes[i], head);
+    }
+    out.write(head.data(), std::streamsize(head.size()));
+    size_t ret = head.size();
+    for (size_t i = 0; i < blocks; ++i)
+    {
+        const auto block = packed[i].empty()? s.substr(i * blockBytes, blockBytes): std::string_view{packed[i]};
+        out.write(block.data(), std::streamsize(block.size()));
+        ret += block.size();
+    }
+    return ret;
+}
+
+std::tuple<std::string,bool> load_compressed_str(std::istream &in, unsigned threads)
+/*! Load what is saved by save_compressed_str(), decompressing & verifying blocks in parallel.
+    \param [in] threads Number of threads to decompress blocks; 0 for std::thread::hardware_concurrency()
+    \return The loaded string and whether it was loaded intact.
+
+    Sizes in the header are checked against one another and against the bytes actually read before they size
+    any allocation, so a corrupt or hostile input fails rather than allocating what it claims.
+*/
+{
+    std::string head(HEADER_BYTES, '\0');
+    if (!in.read(head.data(), std::streamsize(head.size())))
+        return {std::string{}, false};
+
+    C_BinReader hr{std::as_bytes(std::span{head})};
+    const auto magic = hr.readLE<std::uint32_t>();
+    const auto ver = hr.readLE<std::uint32_t>();
+    const auto total = hr.readLE<std::uint64_t>();
+    const size_t blockBytes = hr.readLE<std::uint32_t>();
+    const size_t blocks = hr.readLE<std::uint32_t>();
+    if (magic != COMPRESSED_STR_MAGIC || ver != COMPRESSED_STR_VERSION || !blockBytes || blockBytes >= STORED_RAW ||
+        blocks != total / blockBytes + (total % blockBytes != 0))
+        return {std::string{}, false};
+
+    std::string table;
+    if (!readChunked(in, table, std::uint64_t(blocks) * BLOCK_ENTRY_BYTES))
+        return {std::string{}, false};
+
+    struct C_Block
+    {
+        size_t          m_from, m_bytes, m_rawBytes;
+        std::uint64_t   m_hash;
+        bool            m_stored;
+    };
+    std::vector<C_Block> info(blocks); // No larger than the table just read
+    C_BinReader tr{std::as_bytes(std::span{table})};
+    std::uint64_t packedBytes = 0;
+    for (size_t i = 0; i < blocks; ++i)
+    {
+        auto &dst = info[i];
+        const auto bytes = tr.readLE<std::uint32_t>();
+        dst.m_hash = tr.readLE<std::uint64_t>();
+        dst.m_from = size_t(packedBytes);
+        dst.m_stored = bytes & STORED_RAW;
+        dst.m_bytes = bytes & ~STORED_RAW;
+        dst.m_rawBytes = size_t(std::min<std::uint64_t>(blockBytes, total - i * blockBytes));
+        if (dst.m_stored?
+            dst.m_bytes != dst.m_rawBytes:
+            // save_compressed_str() stores a block raw unless it shrinks, and LZ can't expand beyond MAX_RATIO
+            !dst.m_bytes || dst.m_bytes >= dst.m_rawBytes || dst.m_rawBytes / MAX_RATIO > dst.m_bytes)
+            return {std::string{}, false};
+
+        packedBytes += dst.m_bytes;
+    }
+    table = {};
+
+    // Read all blocks before decompressing them in parallel
+    std::string packed;
+    if (!readChunked(in, packed, packedBytes))
+        return {std::string{}, false};
+
+    std::string ret(size_t(total), '\0');
+    std::atomic<bool> ok{true};
+    forEachJob(blocks, threads, [&](size_t i) {
+        const auto &b = info[i];
+        const auto dst = ret.data() + i * blockBytes;
+        const std::string_view src{packed.data() + b.m_from, b.m_bytes};
+        if (b.m_stored)
+            memcpy(dst, src.data(), src.size());
+        else if (!lz_decompress(src, dst, b.m_rawBytes))
+        {
+            ok = false;
+            return;
+        }
+        if (hash64(dst, b.m_rawBytes) != b.m_hash)
+            ok = false;
+    });
+    return {std::move(ret), ok.load()};
+}
+
+} // namespace bux
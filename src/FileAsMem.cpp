@@ -1,54 +1,454 @@
 #include "FileAsMem.h"
 #ifndef _WIN32
-#include <sys/mman.h>           // mmap(), munmap()
+#include <sys/mman.h>           // mmap(), mremap(), munmap(), madvise()
+#include <sys/stat.h>           // fstat()
 #include <fcntl.h>              // open()
-#include <unistd.h>             // lseek()
+#include <unistd.h>             // close(), ftruncate(), sysconf()
 #endif
-#include <stdexcept>            // std::runtime_error
+#include <algorithm>            // std::max()
+#include <cerrno>               // errno
+#include <cstring>              // memcpy()
+#include <stdexcept>            // std::out_of_range
+#include <system_error>         // std::system_error
+#include <utility>              // std::exchange()
+
+namespace {
+
+//
+//      In-Module Types
+//
+#ifdef _WIN32
+using T_FileHandle = HANDLE;
+#else
+using T_FileHandle = int;
+#endif
+
+class C_FileHandle
+{
+public:
+
+    // Nonvirtuals
+    explicit C_FileHandle(T_FileHandle h): m_handle(h) {}
+    ~C_FileHandle()
+    {
+#ifdef _WIN32
+        if (m_handle && m_handle != INVALID_HANDLE_VALUE)
+            CloseHandle(m_handle);
+#else
+        if (m_handle != -1)
+            close(m_handle);
+#endif
+    }
+    C_FileHandle(const C_FileHandle&) = delete;
+    operator T_FileHandle() const { return m_handle; }
+
+private:
+
+    // Data
+    const T_FileHandle m_handle;
+};
+
+//
+//      In-Module Functions
+//
+[[noreturn]] void throwLastError(const std::string &what)
+{
+#ifdef _WIN32
+    throw std::system_error{int(GetLastError()), std::system_category(), what};
+#else
+    throw std::system_error{errno, std::generic_category(), what};
+#endif
+}
+
+} // namespace
 
 namespace bux {
 
-C_FileAsMemory::C_FileAsMemory(const std::filesystem::path& path)
+//
+//      Implement Classes
+//
+C_FileAsMemory::C_FileAsMemory(const std::filesystem::path& path, E_MemAdvice advice)
+{
+    map(path, 0, npos);
+    if (advice != MA_NORMAL)
+        (void)advise(advice);
+}
+
+C_FileAsMemory::C_FileAsMemory(const std::filesystem::path& path, std::uint64_t offset, size_t bytes, E_MemAdvice advice)
+/*! \param [in] path File to map.
+    \param [in] offset Byte offset in file where the view starts. Need not be aligned.
+    \param [in] bytes Bytes to view; clipped to the end of file.
+    \param [in] advice Initial hint of access pattern.
+    \throw std::out_of_range if \em offset is beyond the end of file.
+    \throw std::system_error on failure to open or to map the file.
+*/
+{
+    map(path, offset, bytes);
+    if (advice != MA_NORMAL)
+        (void)advise(advice);
+}
+
+C_FileAsMemory::C_FileAsMemory(C_FileAsMemory &&other) noexcept:
+    m_base(std::exchange(other.m_base, nullptr)),
+    m_mapBytes(std::exchange(other.m_mapBytes, 0)),
+    m_data(std::exchange(other.m_data, nullptr)),
+    m_bytes(std::exchange(other.m_bytes, 0)),
+    m_offset(std::exchange(other.m_offset, 0))
+{
+}
+
+C_FileAsMemory::~C_FileAsMemory()
+{
+    unmap();
+}
+
+C_FileAsMemory &C_FileAsMemory::operator=(C_FileAsMemory &&other) noexcept
+{
+    if (this != &other)
+    {
+        unmap();
+        m_base      = std::exchange(other.m_base, nullptr);
+        m_mapBytes  = std::exchange(other.m_mapBytes, 0);
+        m_data      = std::exchange(other.m_data, nullptr);
+        m_bytes     = std::exchange(other.m_bytes, 0);
+        m_offset    = std::exchange(other.m_offset, 0);
+    }
+    return *this;
+}
+
+bool C_FileAsMemory::advise(E_MemAdvice advice, size_t off, size_t bytes) const noexcept
+/*! \param [in] advice Hint of access pattern.
+    \param [in] off Start of the advised range relative to data()
+    \param [in] bytes Size of the advised range; clipped to the end of view.
+    \return true if the hint is taken or there is nothing to advise.
+*/
 {
+    if (off >= m_bytes)
+        return true;
+    if (bytes > m_bytes - off)
+        bytes = m_bytes - off;
+
+    // Align the range to page boundaries
+    const auto gran = granularity();
+    const auto start = size_t(m_data - m_base) + off;
+    const auto alignedStart = start / gran * gran;
+    auto *const addr = m_base + alignedStart;
+    const auto len = bytes + (start - alignedStart);
 #ifdef _WIN32
-    const auto hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    switch (advice)
+    {
+    case MA_NORMAL:
+        return true;
+#if _WIN32_WINNT >= 0x0602
+    case MA_WILLNEED:
+    {
+        WIN32_MEMORY_RANGE_ENTRY range{addr, len};
+        return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#endif
+    default:
+        return false;
+    }
+#else
+    int flag;
+    switch (advice)
+    {
+    case MA_NORMAL:
+        flag = MADV_NORMAL;
+        break;
+    case MA_SEQUENTIAL:
+        flag = MADV_SEQUENTIAL;
+        break;
+    case MA_RANDOM:
+        flag = MADV_RANDOM;
+        break;
+    case MA_WILLNEED:
+        flag = MADV_WILLNEED;
+        break;
+    case MA_DONTNEED:
+        flag = MADV_DONTNEED;
+        break;
+    case MA_HUGEPAGE:
+#ifdef MADV_HUGEPAGE
+        flag = MADV_HUGEPAGE;
+        break;
+#endif
+    default:
+        return false;
+    }
+    return !madvise(addr, len, flag);
+#endif
+}
+
+size_t C_FileAsMemory::granularity() noexcept
+{
+    static const size_t ret = []{
+#ifdef _WIN32
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        return size_t(si.dwAllocationGranularity);
+#else
+        return size_t(sysconf(_SC_PAGESIZE));
+#endif
+    }();
+    return ret;
+}
+
+void C_FileAsMemory::map(const std::filesystem::path& path, std::uint64_t offset, size_t bytes)
+{
+#ifdef _WIN32
+    C_FileHandle hFile{CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)};
     if (hFile == INVALID_HANDLE_VALUE)
-        throw std::runtime_error{"Failed to open \" + path.string() + \" for read-only"};
+        throwLastError("Failed to open \"" + path.string() + "\" for read-only");
 
-    m_handle = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
-    CloseHandle(hFile);
-    if (!m_handle)
-        throw std::runtime_error{"Failed to create file mapping"};
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize))
+        throwLastError("Failed to get size of \"" + path.string() + '\"');
 
-    m_data = static_cast<char*>(MapViewOfFile(m_handle, FILE_MAP_READ, 0, 0, 0));
-    if (!m_data)
-        CloseHandle(m_handle);
+    const auto fileBytes = std::uint64_t(fileSize.QuadPart);
+#else
+    C_FileHandle fd{open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fd == -1)
+        throwLastError("Failed to open \"" + path.string() + "\" for read-only");
+
+    struct stat st;
+    if (fstat(fd, &st))
+        throwLastError("Failed to get size of \"" + path.string() + '\"');
+
+    const auto fileBytes = std::uint64_t(st.st_size);
+#endif
+    if (offset > fileBytes)
+        throw std::out_of_range{"Offset " + std::to_string(offset) + " passes end of \"" + path.string() + '\"'};
+    if (bytes > fileBytes - offset)
+        bytes = size_t(fileBytes - offset);
+
+    m_offset = offset;
+    m_bytes = bytes;
+    if (!bytes)
+        // Nothing to map
+        return;
+
+    const auto delta = size_t(offset % granularity());
+    const auto start = offset - delta;
+    m_mapBytes = bytes + delta;
+#ifdef _WIN32
+    C_FileHandle hMap{CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr)};
+    if (!hMap)
+        throwLastError("Failed to create file mapping of \"" + path.string() + '\"');
+
+    m_base = static_cast<char*>(MapViewOfFile(hMap, FILE_MAP_READ, DWORD(start >> 32), DWORD(start), m_mapBytes));
+    if (!m_base)
+        throwLastError("Failed to map \"" + path.string() + "\" into memory");
+#else
+    const auto data = mmap(nullptr, m_mapBytes, PROT_READ, MAP_PRIVATE, fd, off_t(start));
+    if (data == MAP_FAILED)
+        throwLastError("Failed to map \"" + path.string() + "\" into memory");
+
+    m_base = static_cast<char*>(data);
+#endif
+    m_data = m_base + delta;
+}
+
+void C_FileAsMemory::unmap() noexcept
+{
+    if (m_base)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_base);
 #else
-    m_fd = open(path.c_str(), O_RDONLY);
+        munmap(m_base, m_mapBytes);
+#endif
+        m_base = nullptr;
+    }
+}
+
+C_OFileAsMemory::C_OFileAsMemory(const std::filesystem::path& path, size_t reserve_)
+/*! \param [in] path File to create or to overwrite.
+    \param [in] reserve_ Bytes to reserve up front.
+    \throw std::system_error on failure to create or to map the file.
+*/
+{
+#ifdef _WIN32
+    m_file = CreateFileW(path.c_str(), GENERIC_READ|GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        throwLastError("Failed to create \"" + path.string() + '\"');
+#else
+    m_fd = open(path.c_str(), O_RDWR|O_CREAT|O_TRUNC|O_CLOEXEC, 0666);
     if (m_fd == -1)
-        throw std::runtime_error{"Failed to open \"" + path.string() + "\" for read-only"};
+        throwLastError("Failed to create \"" + path.string() + '\"');
+#endif
+    if (reserve_)
+        try
+        {
+            reserve(reserve_);
+        }
+        catch (...)
+        {
+            finalize();
+            throw;
+        }
+}
 
-    m_bytes = (size_t)lseek(m_fd, 0, SEEK_END);
-    auto data = mmap(nullptr, m_bytes, PROT_READ, MAP_PRIVATE, m_fd, 0);
-    if (data != MAP_FAILED)
-        m_data = static_cast<char*>(data);
-    else
-        close(m_fd);
+C_OFileAsMemory::C_OFileAsMemory(C_OFileAsMemory &&other) noexcept:
+    m_data(std::exchange(other.m_data, nullptr)),
+    m_size(std::exchange(other.m_size, 0)),
+    m_capacity(std::exchange(other.m_capacity, 0)),
+#ifdef _WIN32
+    m_file(std::exchange(other.m_file, INVALID_HANDLE_VALUE)),
+    m_mapping(std::exchange(other.m_mapping, nullptr))
+#else
+    m_fd(std::exchange(other.m_fd, -1))
 #endif
+{
 }
 
-C_FileAsMemory::~C_FileAsMemory()
+C_OFileAsMemory::~C_OFileAsMemory()
 {
-    if (m_data)
+    try
     {
+        finalize();
+    }
+    catch (...)
+    {
+    }
+}
+
+C_OFileAsMemory &C_OFileAsMemory::operator=(C_OFileAsMemory &&other)
+/*! \throw std::system_error if finalize() of the current file fails, with \em other left intact.
+*/
+{
+    if (this != &other)
+    {
+        finalize();
+        m_data      = std::exchange(other.m_data, nullptr);
+        m_size      = std::exchange(other.m_size, 0);
+        m_capacity  = std::exchange(other.m_capacity, 0);
+#ifdef _WIN32
+        m_file      = std::exchange(other.m_file, INVALID_HANDLE_VALUE);
+        m_mapping   = std::exchange(other.m_mapping, nullptr);
+#else
+        m_fd        = std::exchange(other.m_fd, -1);
+#endif
+    }
+    return *this;
+}
+
+void C_OFileAsMemory::append(const char *src, size_t bytes)
+{
+    if (!bytes)
+        // m_data may be null
+        return;
+
+    reserve(m_size + bytes);
+    memcpy(m_data + m_size, src, bytes);
+    m_size += bytes;
+}
+
+void C_OFileAsMemory::commit(size_t bytes)
+{
+    if (bytes > m_capacity - m_size)
+        throw std::out_of_range{"Commit " + std::to_string(bytes) + " bytes beyond capacity"};
+
+    m_size += bytes;
+}
+
+void C_OFileAsMemory::finalize()
+{
 #ifdef _WIN32
+    if (m_file == INVALID_HANDLE_VALUE)
+        return;
+
+    if (m_data)
         UnmapViewOfFile(m_data);
-        CloseHandle(m_handle);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_capacity = 0;
+    const auto file = std::exchange(m_file, INVALID_HANDLE_VALUE);
+    LARGE_INTEGER size;
+    size.QuadPart = LONGLONG(m_size);
+    const bool ok = SetFilePointerEx(file, size, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+    CloseHandle(file);
+    if (!ok)
+        throwLastError("Failed to truncate mapped file to " + std::to_string(m_size) + " bytes");
 #else
-        munmap(m_data, m_bytes);
-        close(m_fd);
+    if (m_fd == -1)
+        return;
+
+    if (m_data)
+        munmap(m_data, m_capacity);
+
+    m_data = nullptr;
+    m_capacity = 0;
+    const auto fd = std::exchange(m_fd, -1);
+    const bool ok = !ftruncate(fd, off_t(m_size));
+    close(fd);
+    if (!ok)
+        throwLastError("Failed to truncate mapped file to " + std::to_string(m_size) + " bytes");
 #endif
+}
+
+void C_OFileAsMemory::remap(size_t capacity)
+{
+#ifdef _WIN32
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+
+    m_data = nullptr;
+    m_capacity = 0;
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READWRITE, DWORD(std::uint64_t(capacity) >> 32), DWORD(capacity), nullptr);
+    if (!m_mapping)
+        throwLastError("Failed to create file mapping of " + std::to_string(capacity) + " bytes");
+
+    m_data = static_cast<char*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, capacity));
+    if (!m_data)
+        throwLastError("Failed to map " + std::to_string(capacity) + " bytes into memory");
+#else
+    if (ftruncate(m_fd, off_t(capacity)))
+        throwLastError("Failed to resize mapped file to " + std::to_string(capacity) + " bytes");
+
+    void *data;
+#ifdef __linux__
+    if (m_data)
+        data = mremap(m_data, m_capacity, capacity, MREMAP_MAYMOVE);
+    else
+#else
+    if (m_data)
+    {
+        munmap(m_data, m_capacity);
+        m_data = nullptr;
+        m_capacity = 0;
     }
+#endif
+        data = mmap(nullptr, capacity, PROT_READ|PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED)
+        throwLastError("Failed to map " + std::to_string(capacity) + " bytes into memory");
+
+    m_data = static_cast<char*>(data);
+#endif
+    m_capacity = capacity;
+}
+
+void C_OFileAsMemory::reserve(size_t bytes)
+/*! Capacity is at least doubled on each growth so that appending byte by byte stays amortized O(1).
+*/
+{
+    if (bytes <= m_capacity)
+        return;
+
+    const auto gran = C_FileAsMemory::granularity();
+    bytes = std::max(bytes, m_capacity * 2);
+    remap((bytes + gran - 1) / gran * gran);
+}
+
+std::span<char> C_OFileAsMemory::spare(size_t minBytes)
+{
+    reserve(m_size + minBytes);
+    return {m_data + m_size, m_capacity - m_size};
 }
 
 } // namespace bux
@@ -0,0 +1,148 @@
+#include "Hash64.h"
+#include <algorithm>    // std::min()
+#include <bit>          // std::rotl(), std::endian, std::byteswap()
+#include <cstring>      // memcpy()
+
+namespace {
+
+//
+//      In-Module Constants
+//
+constexpr std::uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+//
+//      In-Module Functions
+//
+template<class T>
+T readLE(const unsigned char *p) noexcept
+{
+    T ret;
+    memcpy(&ret, p, sizeof ret);
+    if constexpr (std::endian::native == std::endian::big)
+        ret = std::byteswap(ret);
+    return ret;
+}
+
+inline std::uint64_t round(std::uint64_t acc, std::uint64_t input) noexcept
+{
+    return std::rotl(acc + input * PRIME2, 31) * PRIME1;
+}
+
+inline std::uint64_t mergeRound(std::uint64_t h, std::uint64_t acc) noexcept
+{
+    return (h ^ round(0, acc)) * PRIME1 + PRIME4;
+}
+
+const unsigned char *consumeStripes(std::uint64_t (&acc)[4], const unsigned char *p, const unsigned char *end) noexcept
+{
+    // The 4 lanes are independent of each other so the loop is friendly to both ILP & auto-vectorization.
+    auto a0 = acc[0], a1 = acc[1], a2 = acc[2], a3 = acc[3];
+    for (; end - p >= 32; p += 32)
+    {
+        a0 = round(a0, readLE<std::uint64_t>(p));
+        a1 = round(a1, readLE<std::uint64_t>(p + 8));
+        a2 = round(a2, readLE<std::uint64_t>(p + 16));
+        a3 = round(a3, readLE<std::uint64_t>(p + 24));
+    }
+    acc[0] = a0, acc[1] = a1, acc[2] = a2, acc[3] = a3;
+    return p;
+}
+
+std::uint64_t finalize(std::uint64_t h, const unsigned char *p, size_t bytes) noexcept
+{
+    for (; bytes >= 8; p += 8, bytes -= 8)
+        h = std::rotl(h ^ round(0, readLE<std::uint64_t>(p)), 27) * PRIME1 + PRIME4;
+    if (bytes >= 4)
+    {
+        h = std::rotl(h ^ (readLE<std::uint32_t>(p) * PRIME1), 23) * PRIME2 + PRIME3;
+        p += 4;
+        bytes -= 4;
+    }
+    for (; bytes; ++p, --bytes)
+        h = std::rotl(h ^ (*p * PRIME5), 11) * PRIME1;
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+std::uint64_t mergeLanes(const std::uint64_t (&acc)[4]) noexcept
+{
+    auto h = std::rotl(acc[0], 1) + std::rotl(acc[1], 7) + std::rotl(acc[2], 12) + std::rotl(acc[3], 18);
+    for (auto i: acc)
+        h = mergeRound(h, i);
+    return h;
+}
+
+} // namespace
+
+namespace bux {
+
+//
+//      Implement Classes
+//
+std::uint64_t C_Hash64::digest() const noexcept
+{
+    auto h = m_total >= 32? mergeLanes(m_acc): m_seed + PRIME5;
+    return finalize(h + m_total, m_stripe, m_pending);
+}
+
+void C_Hash64::reset(std::uint64_t seed) noexcept
+{
+    m_acc[0] = seed + PRIME1 + PRIME2;
+    m_acc[1] = seed + PRIME2;
+    m_acc[2] = seed;
+    m_acc[3] = seed - PRIME1;
+    m_seed = seed;
+    m_total = 0;
+    m_pending = 0;
+}
+
+void C_Hash64::update(const void *data, size_t bytes) noexcept
+{
+    auto p = static_cast<const unsigned char*>(data);
+    const auto end = p + bytes;
+    m_total += bytes;
+    if (m_pending)
+    {
+        const auto n = std::min(bytes, sizeof m_stripe - m_pending);
+        memcpy(m_stripe + m_pending, p, n);
+        p += n;
+        if ((m_pending += n) < sizeof m_stripe)
+            return;
+
+        consumeStripes(m_acc, m_stripe, m_stripe + sizeof m_stripe);
+        m_pending = 0;
+    }
+    p = consumeStripes(m_acc, p, end);
+    memcpy(m_stripe, p, m_pending = size_t(end - p));
+}
+
+//
+//      Implement Functions
+//
+std::uint64_t hash64(const void *data, size_t bytes, std::uint64_t seed) noexcept
+{
+    const auto p = static_cast<const unsigned char*>(data);
+    std::uint64_t h;
+    const unsigned char *tail = p;
+    if (bytes >= 32)
+    {
+        std::uint64_t acc[4]{seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1};
+        tail = consumeStripes(acc, p, p + bytes);
+        h = mergeLanes(acc);
+    }
+    else
+        h = seed + PRIME5;
+
+    return finalize(h + bytes, tail, bytes - size_t(tail - p));
+}
+
+} // namespace bux
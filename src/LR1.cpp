@@ -1,11 +1,132 @@
 #include "LR1.h"
 #include "StrUtil.h"    // HRTN()
+#include <algorithm>    // std::lower_bound(), std::min()
 #include <format>       // std::format()
 #include <limits>       // std::numeric_limits<>
+#include <unordered_map> // std::unordered_map<>
+#include <vector>       // std::vector<>
 
 namespace bux {
 namespace LR1 {
 
+//
+//      Explicit Instantiations
+//
+template class C_ParserImplT<C_Parser>;
+
+//
+//      In-Module Types
+//
+struct C_Parser::C_Frame
+/* Stack entry of checkpoints, chained from top to bottom
+*/
+{
+    // Data
+    C_LexInfo                   m_Info;     // Cloned by I_ParserPolicy::cloneLex()
+    T_StateID                   m_StateID{};
+    T_LexID                     m_TokenID{};
+    size_t                      m_Span{};   // Count of tokens reduced into the entry
+    std::shared_ptr<C_Frame>    m_Below;
+
+    // Ctor/Dtor
+    C_Frame() = default;
+    ~C_Frame();
+};
+
+struct C_Parser::C_Segment
+/* The top (m_Depth - m_Cut) entries of a checkpoint stack, on top of m_Below of depth m_Cut, so that checkpoints
+   share the bottom entries they have in common
+*/
+{
+    // Data
+    std::shared_ptr<C_Frame>    m_Top;
+    size_t                      m_Depth;
+    size_t                      m_Cut;
+    std::shared_ptr<C_Segment>  m_Below;
+
+    // Ctor/Dtor
+    ~C_Segment();
+};
+
+namespace {
+
+//
+//      In-Module Functions
+//
+template<class T>
+void unchain(std::shared_ptr<T> below)
+/* Release the chain iteratively instead of recursively by destructors, which may overflow the call stack
+*/
+{
+    while (below && below.use_count() == 1)
+        below = std::move(below->m_Below);
+}
+
+template<class T_Segment, class F_Visit>
+bool visitTopDown(const T_Segment *seg, F_Visit &&visit)
+/* Call visit() on the entries of a checkpoint stack from the top down until it returns false
+*/
+{
+    for (; seg; seg = seg->m_Below.get())
+    {
+        auto *f = seg->m_Top.get();
+        for (auto i = seg->m_Depth; i > seg->m_Cut; --i, f = f->m_Below.get())
+            if (!visit(*f))
+                return false;
+    }
+    return true;
+}
+
+template<class T_Segment>
+std::shared_ptr<T_Segment> truncate(std::shared_ptr<T_Segment> stack, size_t depth)
+/* The bottom depth entries of a checkpoint stack
+*/
+{
+    while (stack && stack->m_Depth > depth)
+    {
+        if (stack->m_Cut < depth)
+        {
+            auto *top = &stack->m_Top;
+            for (auto i = stack->m_Depth; i > depth; --i)
+                top = &(*top)->m_Below;
+
+            return std::make_shared<T_Segment>(*top, depth, stack->m_Cut, stack->m_Below);
+        }
+        stack = stack->m_Below;
+    }
+    return stack;
+}
+
+template<class T_Segment>
+std::shared_ptr<T_Segment> rebase(const std::shared_ptr<T_Segment> &stack, size_t depth,
+    const std::shared_ptr<T_Segment> &base, std::unordered_map<const T_Segment*,std::shared_ptr<T_Segment>> &rebased)
+/* Checkpoint stack of the entries of stack from depth on, on top of base of depth entries. Segments shared by
+   the stacks rebased thru the same rebased map stay shared
+*/
+{
+    std::vector<const T_Segment*> above;
+    auto ret = base;
+    for (auto *i = stack.get(); i && i->m_Depth > depth; i = i->m_Below.get())
+    {
+        if (const auto found = rebased.find(i); found != rebased.end())
+        {
+            ret = found->second;
+            break;
+        }
+        above.emplace_back(i);
+        if (i->m_Cut <= depth)
+            break;
+    }
+    for (auto i = above.rbegin(); i != above.rend(); ++i)
+    {
+        ret = std::make_shared<T_Segment>((*i)->m_Top, (*i)->m_Depth, std::max((*i)->m_Cut, depth), ret);
+        rebased.emplace(*i, ret);
+    }
+    return ret;
+}
+
+} // namespace
+
 //
 //      Implement Classes
 //
@@ -14,6 +135,15 @@ bool I_ParserPolicy::changeToken(T_LexID &, C_LexPtr &) const
     return false;
 }
 
+bool I_ParserPolicy::cloneLex(const C_LexPtr &src, C_LexPtr &dst) const
+{
+    if (src)
+        return false;
+
+    dst.clear();
+    return true;
+}
+
 bool I_ParserPolicy::getTokenName(T_LexID, std::string &) const
 {
     return false;
@@ -25,6 +155,14 @@ std::string I_ParserPolicy::printToken(T_LexID token) const
     if (getTokenName(token, name))
         return name;
 
+    return printTokenId(token);
+}
+
+//
+//      Functions
+//
+std::string printTokenId(T_LexID token)
+{
     switch (token)
     {
     case TID_EOF:
@@ -44,259 +182,249 @@ std::string I_ParserPolicy::printToken(T_LexID token) const
 }
 
 C_Parser::C_Parser(const I_ParserPolicy &policy):
-    m_Policy(policy),
-    m_ErrState(std::numeric_limits<T_StateID>::max()),
-    m_ShiftCountdown(0),
-    m_Accepted(false)
-{
-}
-
-void C_Parser::add(T_LexID token, unsigned line, unsigned col, I_LexAttr *unownedAttr)
+    m_Policy(policy)
 {
-    C_LexInfo   info;
-    info.m_attr.assign(unownedAttr, true);
-    info.m_pos.m_Source = m_CurSrc;
-    info.m_pos.m_Line = line;
-    info.m_pos.m_Col  = col;
-
-    C_StateStackLR1 unreadStack;
-    add(token, info, unreadStack);
 }
 
-void C_Parser::add(T_LexID token, C_LexInfo &info, C_StateStackLR1 &unreadStack)
+bool C_Parser::checkpoint(C_Checkpoint &dst, const C_Checkpoint *prev)
 {
-    size_t actionid;
-Again:
-    if (m_Accepted)
-        onError(info, "Already accepted");
-
-    actionid = m_Policy.action(currentState(), token);
-    switch (actionid)
+    if (m_OnPostShift)
+        return false;
+
+    const auto depth = m_CurStack.size();
+    size_t shared{};
+    std::shared_ptr<C_Segment> stack;
+    if (prev && !m_Marked.owner_before(prev->m_Stack) && !prev->m_Stack.owner_before(m_Marked))
+        // Entries below m_LowWater are untouched since prev
     {
-    case ACTION_SHIFT:
-        shift(token, info);
-        if (m_ShiftCountdown && !--m_ShiftCountdown)
-            // Call and forget
-        {
-            std::function<void()> t;
-            t.swap(m_OnPostShift);
-            t();
-        }
-        break;
-    case ACTION_ACCEPT:
-        if (m_OnPostShift)
-            // Call and forget
+        shared = std::min({m_LowWater, prev->m_Depth, depth});
+        stack = truncate(prev->m_Stack, shared);
+    }
+    if (depth > shared)
+    {
+        std::shared_ptr<C_Frame> top;
+        for (auto i = shared; i < depth; ++i)
         {
-            std::function<void()> t;
-            t.swap(m_OnPostShift);
-            m_ShiftCountdown = 0;
-            t();
+            const auto &src = m_CurStack[i];
+            auto t = std::make_shared<C_Frame>();
+            if (!m_Policy.cloneLex(src.m_attr, t->m_Info.m_attr))
+                return false;
+
+            t->m_Info.m_pos = src.m_pos;
+            t->m_StateID = src.m_StateID;
+            t->m_TokenID = src.m_TokenID;
+            t->m_Span = (i + 1 < depth? m_CurStack[i+1].m_FirstToken: m_Tokens) - src.m_FirstToken;
+            t->m_Below = std::move(top);
+            top = std::move(t);
         }
-        if (!reduceOn(m_Policy.getAcceptId(), info))
-            onError(info, "Reduction error on acception");
+        stack = std::make_shared<C_Segment>(std::move(top), depth, shared, std::move(stack));
+    }
+    dst.m_Stack = stack;
+    dst.m_Depth = depth;
+    dst.m_Shared = shared;
+    dst.m_Tokens = m_Tokens;
+    dst.m_Errors = m_Errors;
+    dst.m_Accepted = m_Accepted;
+    m_Marked = stack;
+    m_LowWater = depth;
+    return true;
+}
 
-        m_Accepted = true;
-        break;
-    case ACTION_ERROR: // Error
-        if (m_Policy.changeToken(token, info.m_attr))
-            goto Again;
+void C_Parser::onError(const C_SourcePos &pos, std::string_view message)
+{
+    m_Policy.onError(*this, pos, message);
+}
 
-        if (m_ErrState == std::numeric_limits<T_StateID>::max())
-        {
-            m_ErrState = currentState();
-            m_ErrToken = token;
-            m_ErrPos   = info.m_pos;
-        }
+I_ParserPolicy::C_ReduceInfo C_Parser::reduction(size_t id) const
+{
+    I_ParserPolicy::C_ReduceInfo ret;
+    m_Policy.getReduceInfo(id, ret);
+    return ret;
+}
 
-        if (recover(token, info, unreadStack))
-            // Recoverable
-        {
-            info.m_attr.assign(0, false);
-            add(m_Policy.m_IdError, info, unreadStack);
-        }
-        else
-            // Unrecoverable
-        {
-            auto out = std::format("Syntax error on state={} token={}", m_ErrState, m_Policy.printToken(m_ErrToken));
-            if (auto *attr =info.m_attr.get())
-                out.append(" of attr type ").append(HRTN(*attr));
-            else
-                out += " with null attr";
-
-            if (m_CurStack.empty())
-                out += "\nEmpty stack";
-            else
-            {
-                out += std::format("\nStack[{}] Dump:", m_CurStack.size()-1);
-                bool first = true;
-                for (const auto &i: m_CurStack)
-                {
-                    if (first)
-                        first = false;
-                    else
-                        out += std::format("\n({},{})\t{}\ts={}\tt={}",
-                                i.m_pos.m_Line, i.m_pos.m_Col, i.m_attr?HRTN(*i):"", i.m_StateID, m_Policy.printToken(i.m_TokenID));
-                }
-            }
-            onError(m_ErrPos, out);
-            if (token == TID_EOF)
-                m_Accepted = true;
-            else
-            {
-                panicRollback(unreadStack); // panic mode the cheapest
-                m_ErrState = std::numeric_limits<T_StateID>::max();
-            }
-        }
-        break;
-    default:
-        if (actionid >= ACTION_REDUCE_MIN)
-        {
-            const size_t prodId = actionid - ACTION_REDUCE_MIN;
-            if (reduceOn(prodId, info.m_pos))
-            {
-                m_ErrState = std::numeric_limits<T_StateID>::max();
-                goto Again;
-            }
-            onError(info, "Reduction error on production "+std::to_string(prodId));
-        }
-        onError(info, "Unknown action id "+std::to_string(actionid));
-    } // switch (actionid)
+void C_Parser::restore(const C_Checkpoint &src)
+{
+    restoreAbove(src, 0);
+}
 
-    // Consume unread
-    if (!unreadStack.empty())
+void C_Parser::restoreAbove(const C_Checkpoint &src, size_t depth)
+{
+    std::vector<std::pair<const C_Frame*,size_t>> frames; // with the first token index
+    frames.reserve(src.m_Depth - depth);
+    auto firstToken = src.m_Tokens;
+    visitTopDown(src.m_Stack.get(), [&](const C_Frame &f) {
+        if (frames.size() + depth >= src.m_Depth)
+            return false;
+
+        firstToken -= f.m_Span;
+        frames.emplace_back(&f, firstToken);
+        return true;
+    });
+    m_CurStack.pop(m_CurStack.size() - std::min(depth, m_CurStack.size()));
+    for (auto i = frames.rbegin(); i != frames.rend(); ++i)
     {
-       token = unreadStack.top().m_TokenID;
-       info = unreadStack.top();
-       unreadStack.pop();
-       goto Again;
+        auto &f = *i->first;
+        auto &t = m_CurStack.push();
+        if (!m_Policy.cloneLex(f.m_Info.m_attr, t.m_attr))
+        {
+            m_CurStack.clear();
+            throw std::runtime_error{"Checkpoint at token " + std::to_string(src.m_Tokens) + " not cloneable"};
+        }
+        t.m_pos = f.m_Info.m_pos;
+        t.m_StateID = f.m_StateID;
+        t.m_TokenID = f.m_TokenID;
+        t.m_FirstToken = i->second;
     }
+    m_Tokens = src.m_Tokens;
+    m_Errors = src.m_Errors;
+    m_Accepted = src.m_Accepted;
+    m_ErrState = std::numeric_limits<T_StateID>::max();
+    m_OnPostShift = {};
+    m_ShiftCountdown = 0;
+    m_Marked = src.m_Stack;
+    m_LowWater = m_CurStack.size();
 }
 
-T_StateID C_Parser::currentState() const
+bool C_Parser::sameStates(const C_Checkpoint &cp) const
 {
-    if (m_CurStack.empty())
-        return 0; // 0 is reserved as the ID of [ S' -> .S ]
+    if (m_CurStack.size() != cp.m_Depth || m_Accepted != cp.m_Accepted)
+        return false;
 
-    return m_CurStack.top().m_StateID;
+    return visitTopDown(cp.m_Stack.get(), [this, i = m_CurStack.size()](const C_Frame &f) mutable {
+        auto &t = m_CurStack[--i];
+        return t.m_StateID == f.m_StateID && t.m_TokenID == f.m_TokenID;
+    });
 }
 
-void C_Parser::onError(const C_SourcePos &pos, std::string_view message)
+C_Parser::C_Frame::~C_Frame()
 {
-    m_Policy.onError(*this, pos, message);
+    unchain(std::move(m_Below));
 }
 
-void C_Parser::panicRollback(C_StateStackLR1 &unreadStack)
+C_Parser::C_Segment::~C_Segment()
 {
-    size_t finalSize;
-    for (finalSize = 0; finalSize < m_CurStack.size(); ++finalSize)
-    {
-        if (m_CurStack[finalSize].m_TokenID == m_Policy.m_IdError)
-            break;
-    }
+    unchain(std::move(m_Below));
+}
 
-    while (!unreadStack.empty())
+bool C_Checkpoints::converge(C_Parser &parser)
+{
+    const auto &cp = m_Ahead.front().m_Checkpoint;
+    const auto kept = m_Ahead.front().m_Kept;
+    if (parser.m_Errors != cp.m_Errors || !parser.sameStates(cp))
+        return false;
+
+    // The entries the rest of the parse keeps must cover the same tokens after the edit, in number
+    bool same = true;
+    auto end = parser.m_Tokens;
+    visitTopDown(cp.m_Stack.get(), [&, i = parser.m_CurStack.size()](const auto &f) mutable {
+        if (i <= kept)
+            return false;
+
+        const auto first = parser.m_CurStack[--i].m_FirstToken;
+        if (first < m_EditEnd || end - first != f.m_Span)
+            return same = false;
+
+        end = first;
+        return true;
+    });
+    if (!same || !save(parser))
+        return false;
+
+    // Rebase the later checkpoints on the one just saved in place of cp, and splice the last in
+    const auto base = truncate(m_Saved.back().m_Stack, kept);
+    std::unordered_map<const C_Parser::C_Segment*,std::shared_ptr<C_Parser::C_Segment>> rebased;
+    for (auto i = m_Ahead.begin() + 1; i != m_Ahead.end(); ++i)
     {
-        m_CurStack.push(unreadStack.top());
-        unreadStack.pop();
+        auto &t = m_Saved.emplace_back(i->m_Checkpoint);
+        t.m_Stack = rebase(t.m_Stack, kept, base, rebased);
+        t.m_Tokens = t.m_Tokens - m_OldEditEnd + m_EditEnd;
     }
-    while (m_CurStack.size() > finalSize)
-    {
-        C_StateLR1 &top = m_CurStack.top();
-        if (top.m_TokenID != m_Policy.m_IdError)
-            unreadStack.push(top);
+    if (m_Ahead.size() > 1)
+        parser.restoreAbove(m_Saved.back(), kept);
 
-        m_CurStack.pop();
-    }
+    m_Ahead.clear();
+    m_Ended = true;
+    return true;
+}
+
+const C_Parser::C_Checkpoint *C_Checkpoints::find(size_t tokens) const
+{
+    const auto found = std::lower_bound(m_Saved.begin(), m_Saved.end(), tokens,
+        [](const C_Parser::C_Checkpoint &a, size_t b) { return a.m_Tokens < b; });
+    return found != m_Saved.end() && found->m_Tokens == tokens? &*found: nullptr;
 }
 
-bool C_Parser::recover(T_LexID token, C_LexInfo &info, C_StateStackLR1 &unreadStack)
+bool C_Checkpoints::onAdded(C_Parser &parser)
 {
-    bool isLast = true;
-    for (auto i = m_CurStack.size(); i; --i, isLast = false)
+    const auto tokens = parser.tokens();
+    if (m_Ended && m_Saved.back().m_Tokens < tokens)
+        m_Ended = false;
+
+    if (!m_Ahead.empty() && tokens >= m_EditEnd)
     {
-        if (!isLast && m_CurStack[i].m_TokenID == m_Policy.m_IdError)
-            // No crossing old m_Policy.m_IdError
-            break;
+        while (!m_Ahead.empty() && m_Ahead.front().m_Checkpoint.m_Tokens - m_OldEditEnd + m_EditEnd < tokens)
+            m_Ahead.pop_front();
 
-        if (m_Policy.action(m_CurStack[i-1].m_StateID, m_Policy.m_IdError) != ACTION_ERROR)
-        {
-            if (!isLast && info.m_pos == m_CurStack[i].m_pos)
-                // Total length of nonempty ungotten tokens is zero.
-                continue;
-
-            for (size_t j = i; j; --j, isLast = false)
-            {
-                if (m_CurStack[j-1].m_pos < (isLast?info.m_pos:m_CurStack[j].m_pos))
-                    break;
-                if (m_CurStack[j-1].m_TokenID == m_Policy.m_IdError)
-                    return false;
-            }
-
-            auto &t = unreadStack.push();
-            t.m_TokenID = token;
-            static_cast<C_LexInfo &>(t) = info;
-            while (m_CurStack.size() > i)
-            {
-                unreadStack.push(m_CurStack.top());
-                m_CurStack.pop();
-            }
-            info.m_pos = unreadStack.top().m_pos;
+        if (!m_Ahead.empty() && m_Ahead.front().m_Checkpoint.m_Tokens - m_OldEditEnd + m_EditEnd == tokens &&
+            converge(parser))
             return true;
-        }
     }
+    if (tokens >= (m_Saved.empty()? 0: m_Saved.back().m_Tokens) + m_Interval)
+        save(parser);
+
     return false;
 }
 
-bool C_Parser::reduceOn(size_t id, const C_SourcePos &pos)
+void C_Checkpoints::onEnd(C_Parser &parser)
 {
-    I_ParserPolicy::C_ReduceInfo ri;
-    m_Policy.getReduceInfo(id, ri);
-    if (m_CurStack.size() >= ri.m_PopLength)
+    m_Ahead.clear();
+    m_Ended = !m_Saved.empty() && m_Saved.back().m_Tokens == parser.tokens();
+    if (!m_Ended)
+        m_Ended = save(parser);
+}
+
+size_t C_Checkpoints::resume(C_Parser &parser, size_t firstEdited, size_t removed, size_t added)
+{
+    // Checkpoints after no more than firstEdited tokens see only unedited tokens, while those after no less than
+    // firstEdited+removed ones may be where the parse converges if the end of input is also checkpointed
+    m_Ahead.clear();
+    m_EditEnd = firstEdited + added;
+    m_OldEditEnd = firstEdited + removed;
+    auto kept = std::numeric_limits<size_t>::max();
+    while (!m_Saved.empty() && m_Saved.back().m_Tokens > firstEdited)
     {
-        const auto base = m_CurStack.end() - ri.m_PopLength;
-        C_LexInfo li;
-        if (ri.m_Reduce)
-            ri.m_Reduce(*this,
-                        [=,this,size=ri.m_PopLength](size_t n)->C_LexInfo& {
-                            if (n >= size)
-                                onError(pos, "Production["+std::to_string(id)+"] out of range "+std::to_string(n)+'/'+std::to_string(size));
-
-                            return base[n];
-                        }, li.m_attr);
-        if (ri.m_PopLength)
+        auto &i = m_Saved.back();
+        if (m_Ended && i.m_Tokens >= m_OldEditEnd)
         {
-            li.m_pos = base->m_pos;
-            m_CurStack.pop(ri.m_PopLength);
+            m_Ahead.push_front({i, std::min(kept, i.m_Depth)});
+            kept = std::min(kept, i.m_Shared);
         }
-        else
-            li.m_pos = pos;
-
-        shift(ri.m_ResultID, li);
-        return true;
+        m_Saved.pop_back();
     }
-    return false;
-}
+    m_Ended = false;
+    if (m_Saved.empty())
+    {
+        const C_Parser::C_Checkpoint initial;
+        parser.restore(initial);
+    }
+    else
+        parser.restore(m_Saved.back());
 
-void C_Parser::reservePostShift(std::function<void()> calledOnce, unsigned shifts)
-{
-    m_ShiftCountdown = shifts;
-    m_OnPostShift = calledOnce;
-}
+    if (!m_Ahead.empty() && m_Ahead.back().m_Checkpoint.m_Errors != parser.m_Errors)
+        // Spans of stack entries are unreliable after error recovery
+        m_Ahead.clear();
 
-std::string_view C_Parser::setSource(std::string_view src)
-{
-    const auto ret = m_CurSrc;
-    m_CurSrc = src;
-    return ret;
+    return parser.tokens();
 }
 
-void C_Parser::shift(T_LexID token, C_LexInfo &info)
+bool C_Checkpoints::save(C_Parser &parser)
 {
-    const auto state = currentState();
-    auto &t = m_CurStack.push();
-    t.m_StateID = token != ROOT_NID? m_Policy.nextState(state, token): state;
-    t.m_TokenID = token;
-    static_cast<C_LexInfo&>(t) = info;
+    const auto prev = m_Saved.empty()? nullptr: &m_Saved.back();
+    if (parser.checkpoint(m_Saved.emplace_back(), prev))
+        return true;
+
+    m_Saved.pop_back();
+    return false;
 }
 
 } // namespace LR1
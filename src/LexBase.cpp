@@ -1,7 +1,12 @@
 #include "LexBase.h"
 #include "UnicodeCvt.h" // bux::C_UnicodeIn
+#include <atomic>       // std::atomic<>
 #include <cctype>       // isprint()
 #include <cstring>      // strchr()
+#include <functional>   // std::less<>
+#include <memory_resource>  // std::pmr::monotonic_buffer_resource, std::pmr::memory_resource
+#include <utility>      // std::pair<>
+#include <vector>       // std::vector<>
 
 namespace {
 
@@ -108,8 +113,121 @@ void addAsHex(std::string &dst, uint32_t ch32)
 //
 //      Implement Classes
 //
+struct C_LexArena::C_Pool: std::pmr::memory_resource
+{
+    // Data
+    std::vector<std::pair<const char*,const char*>> m_Chunks;   ///< Upstream chunks of m_Resource, newest last
+    std::pmr::monotonic_buffer_resource m_Resource;
+    std::atomic<std::size_t>            m_Refs{1};  ///< The arena itself plus all live lexes
+    std::size_t                         m_Allocations{};
+    std::size_t                         m_Bytes{};
+
+    // Nonvirtuals
+    explicit C_Pool(std::size_t initialBytes): m_Resource(initialBytes, this) {}
+    bool owns(const void *p) const noexcept
+    {
+        constexpr std::less<const void*> less;
+        for (auto i = m_Chunks.rbegin(); i != m_Chunks.rend(); ++i)
+            if (!less(p, i->first) && less(p, i->second))
+                return true;
+
+        return false;
+    }
+    void release() noexcept
+    {
+        if (m_Refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+private:
+
+    // Implement std::pmr::memory_resource
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        const auto ret = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        try
+        {
+            m_Chunks.emplace_back(static_cast<const char*>(ret), static_cast<const char*>(ret) + bytes);
+        }
+        catch (...)
+        {
+            std::pmr::new_delete_resource()->deallocate(ret, bytes, alignment);
+            throw;
+        }
+        return ret;
+    }
+    void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
 I_LexAttr::~I_LexAttr() {}
 
+void I_LexAttr::operator delete(void *p) noexcept
+{
+    // The constructor throwing is still on the thread of the arena
+    if (const auto pool = C_LexArena::t_curArena? C_LexArena::ownerOf(p): nullptr)
+        pool->release();
+    else
+        ::operator delete(p);
+}
+
+C_LexArena::C_LexArena(std::size_t initialBytes):
+    m_Pool(new C_Pool{initialBytes}),
+    m_Outer(t_curArena)
+{
+    t_curArena = this;
+}
+
+C_LexArena::~C_LexArena()
+{
+    t_curArena = m_Outer;
+    m_Pool->release();
+}
+
+std::size_t C_LexArena::allocations() const noexcept
+{
+    return m_Pool->m_Allocations;
+}
+
+std::size_t C_LexArena::bytes() const noexcept
+{
+    return m_Pool->m_Bytes;
+}
+
+C_LexArena *C_LexArena::current() noexcept
+{
+    return t_curArena;
+}
+
+void *C_LexArena::carve(std::size_t bytes)
+{
+    // Only the thread of the arena allocates from it, and constructs what it allocates
+    const auto pool = t_curArena->m_Pool;
+    const auto ret = pool->m_Resource.allocate(bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+    pool->m_Refs.fetch_add(1, std::memory_order_relaxed);
+    ++pool->m_Allocations;
+    pool->m_Bytes += bytes;
+    return ret;
+}
+
+C_LexArena::C_Pool *C_LexArena::ownerOf(const void *p) noexcept
+{
+    const auto pool = t_curArena->m_Pool;
+    return pool->owns(p)? pool: nullptr;
+}
+
+void C_LexArena::release(C_Pool *pool) noexcept
+{
+    // Lexes of any thread may be the last one to go
+    pool->release();
+}
+
 C_SourcePos::C_SourcePos(std::string_view sourcePath, unsigned line, unsigned col) noexcept:
     m_Source(sourcePath), m_Line(line), m_Col(col)
 {
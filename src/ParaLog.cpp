@@ -104,7 +104,7 @@ std::ostream *C_ParaLog::lockLog(E_LogLevel ll)
 void C_ParaLog::unlockLog(bool flush)
 {
     const auto &back = m_lockedStack.back();
-    back.first.log(back.second.str(), flush);
+    back.first.log(back.second.view(), flush);
     m_lockedStack.pop_back();
     m_lock.unlock();
 }
@@ -1,14 +1,39 @@
 #include "Serialize.h"
+#include "Hash64.h"     // bux::C_Hash64, bux::hash64()
 #include <functional>   // std::hash<>
 #include <iterator>     // std::istreambuf_iterator
 #include <istream>      // std::istream
 #include <ostream>      // std::ostream
+#include <stdexcept>    // std::out_of_range, std::runtime_error
+
+namespace {
+
+//
+//      In-Module Constants
+//
+constexpr std::uint32_t HASHED_STR_MAGIC        = 0x68585542;   // "BUXh" in little endian
+constexpr std::uint32_t HASHED_STR_VERSION      = 1;
+constexpr size_t        HASHED_STR_HEADER_BYTES = 4 + 4 + 8 + 8;   // Magic, version, size, hash
+
+} // namespace
 
 namespace bux {
 
 //
 //      Implement Functions
 //
+std::string_view read_view(std::span<const char> src, size_t &off, size_t bytes)
+/*! View \em bytes at \em off of \em src in place, e.g. into a C_FileAsMemory mapping, and move \em off past them.
+    \throw std::out_of_range if it passes the end
+*/
+{
+    C_BinReader in{src};
+    in.skip(off);
+    const auto ret = in.readView(bytes);
+    off += bytes;
+    return ret;
+}
+
 size_t read_size(const std::string &src, size_t &off) noexcept
 {
     size_t n;
@@ -17,18 +42,164 @@ size_t read_size(const std::string &src, size_t &off) noexcept
 }
 
 std::tuple<std::string,size_t,bool> load_hashed_str(std::istream &in)
+/*! Load what is saved by save_hashed_str(), or by its older versions which hashed with std::hash<>.
+    The payload is read in chunks and hashed as it goes.
+*/
 {
-    size_t last_hash;
-    in.read(reinterpret_cast<char*>(&last_hash), sizeof last_hash);
-    const std::string src{std::istreambuf_iterator<char>{in}, {}};
-    return {src, last_hash, std::hash<std::string>{}(src) == last_hash};
+    char head[HASHED_STR_HEADER_BYTES];
+    if (!in.read(head, 4))
+        return {{}, 0, false};
+
+    C_BinReader hr{std::as_bytes(std::span{head})};
+    if (hr.readLE<std::uint32_t>() != HASHED_STR_MAGIC)
+    {
+        // Legacy format: native std::hash<std::string> value followed by the string
+        size_t last_hash;
+        if (!in.read(head + 4, sizeof last_hash - 4))
+            return {{}, 0, false};
+
+        memcpy(&last_hash, head, sizeof last_hash);
+        std::string src;
+        if (const auto n = in.rdbuf()->in_avail(); n > 0)
+        {
+            src.resize(size_t(n));
+            in.read(src.data(), n);
+        }
+        src.append(std::istreambuf_iterator<char>{in}, {});
+        return {src, last_hash, std::hash<std::string>{}(src) == last_hash};
+    }
+
+    if (!in.read(head + 4, HASHED_STR_HEADER_BYTES - 4))
+        return {{}, 0, false};
+
+    const auto ver = hr.readLE<std::uint32_t>();
+    const auto bytes = hr.readLE<std::uint64_t>();
+    const auto last_hash = hr.readLE<std::uint64_t>();
+    if (ver != HASHED_STR_VERSION)
+        return {{}, size_t(last_hash), false};
+
+    // Grow by chunks rather than trusting the size field to allocate it all at once
+    constexpr size_t CHUNK = 1 << 20;
+    std::string src;
+    C_Hash64 h;
+    for (std::uint64_t left = bytes; left;)
+    {
+        const auto n = size_t(std::min<std::uint64_t>(left, CHUNK));
+        const auto off = src.size();
+        src.resize(off + n);
+        in.read(src.data() + off, std::streamsize(n));
+        const auto got = size_t(in.gcount());
+        h.update(src.data() + off, got);
+        if (got < n)
+        {
+            src.resize(off + got);
+            return {src, size_t(last_hash), false};
+        }
+        left -= n;
+    }
+    return {src, size_t(last_hash), h.digest() == last_hash};
 }
 
 size_t save_hashed_str(std::ostream &out, const std::string &s)
+/*! Save \em s after a versioned header which carries its size & its stable hash64().
+*/
 {
-    size_t n = std::hash<std::string>{}(s);
-    out.write(reinterpret_cast<char*>(&n), sizeof n) <<s;
-    return n;
+    const auto h = hash64(s);
+    std::string head;
+    append_le(HASHED_STR_MAGIC, head);
+    append_le(HASHED_STR_VERSION, head);
+    append_le(std::uint64_t(s.size()), head);
+    append_le(h, head);
+    out.write(head.data(), std::streamsize(head.size())).write(s.data(), std::streamsize(s.size()));
+    return size_t(h);
+}
+
+//
+//      Implement Classes
+//
+void C_BinReader::align(size_t alignment)
+{
+    if (const auto misalign = m_pos % alignment)
+        skip(alignment - misalign);
+}
+
+std::string_view C_BinReader::readBlob()
+{
+    const auto pos = m_pos;
+    try
+    {
+        const auto n = readVarint();
+        if (n > remaining())
+            throw std::out_of_range{"Blob of " + std::to_string(n) + " bytes passes the end"};
+
+        return readView(size_t(n));
+    }
+    catch (...)
+    {
+        m_pos = pos;
+        throw;
+    }
+}
+
+std::uint32_t C_BinReader::readTag(std::uint32_t magic, std::uint32_t maxVersion)
+{
+    const auto pos = m_pos;
+    try
+    {
+        if (const auto m = readLE<std::uint32_t>(); m != magic)
+            throw std::runtime_error{"Unexpected magic " + std::to_string(m) + " instead of " + std::to_string(magic)};
+
+        const auto ver = readVarint();
+        if (ver > maxVersion)
+            throw std::runtime_error{"Unsupported version " + std::to_string(ver) + " newer than " + std::to_string(maxVersion)};
+
+        return std::uint32_t(ver);
+    }
+    catch (...)
+    {
+        m_pos = pos;
+        throw;
+    }
+}
+
+std::uint64_t C_BinReader::readVarint()
+{
+    std::uint64_t ret = 0;
+    for (size_t i = m_pos, shift = 0; i < m_src.size() && shift < 64; ++i, shift += 7)
+    {
+        const auto c = std::to_integer<std::uint64_t>(m_src[i]);
+        ret |= (c & 0x7f) << shift;
+        if (!(c & 0x80))
+        {
+            if (shift == 63 && c > 1)
+                break; // Overflow
+            m_pos = i + 1;
+            return ret;
+        }
+    }
+    throw std::out_of_range{"Bad or truncated varint at offset " + std::to_string(m_pos)};
+}
+
+std::string_view C_BinReader::readView(size_t bytes)
+{
+    const auto ret = take(bytes);
+    return {reinterpret_cast<const char*>(ret.data()), ret.size()};
+}
+
+std::int64_t C_BinReader::readZigzag()
+{
+    const auto u = readVarint();
+    return std::int64_t(u >> 1) ^ -std::int64_t(u & 1);
+}
+
+std::span<const std::byte> C_BinReader::take(size_t bytes)
+{
+    if (bytes > remaining())
+        throw std::out_of_range{"Read " + std::to_string(bytes) + " bytes passes the end by " + std::to_string(bytes - remaining())};
+
+    const auto ret = m_src.subspan(m_pos, bytes);
+    m_pos += bytes;
+    return ret;
 }
 
 } // namespace bux
@@ -97,6 +97,33 @@ TEST_CASE("Exceptions", "[E]")
 }
 */
 
+TEST_CASE("Same relation with or without closure", "[S]")
+{
+    for (int round = 0; round < 50; ++round)
+    {
+        const auto n = unsigned(2 + g_rng() % 40);
+        bux::C_PartialOrdering<unsigned> kept, searched{0}, dropped{n / 2};
+        for (auto i = g_rng() % 200; i--;)
+        {
+            const auto a = unsigned(g_rng() % n), b = unsigned(g_rng() % n);
+            const bool added = kept.addOrder(a, b);
+            REQUIRE(searched.addOrder(a, b) == added);
+            REQUIRE(dropped.addOrder(a, b) == added);
+        }
+        REQUIRE(kept.closureKept());
+        REQUIRE((!searched.closureKept() || searched.empty()));
+        for (unsigned a = 0; a < n; ++a)
+            for (unsigned b = 0; b < n; ++b)
+            {
+                const bool related = kept.related(a, b);
+                REQUIRE(searched.related(a, b) == related);
+                REQUIRE(dropped.related(a, b) == related);
+                if (related)
+                    REQUIRE(!kept.related(b, a));
+            }
+    }
+}
+
 TEST_CASE("Scenario: Calling makeLinear() method", "[S][I]")
 {
     bux::C_PartialOrdering<char> po;
@@ -118,4 +145,135 @@ TEST_CASE("Scenario: Calling makeLinear() method", "[S][I]")
     std::string out_default;
     po.makeLinear([&](auto c) { out_default += c; });
     REQUIRE(out_default == out_breadth1st);
-}
+}
+
+TEST_CASE("Schedule after all left-related nodes", "[S]")
+{
+    for (unsigned threads: {1U, 4U})
+    {
+        bux::C_PartialOrdering<unsigned> po;
+        std::vector<std::pair<unsigned,unsigned>> orders;
+        for (int i = 0; i < 300; ++i)
+            if (const auto a = unsigned(g_rng() % 60), b = unsigned(g_rng() % 60); po.addOrder(a, b))
+                orders.emplace_back(a, b);
+
+        std::vector<std::atomic<int>> applied(60);
+        std::atomic<bool> early{false};
+        const auto report = po.schedule([&](unsigned t) {
+            for (auto &i: orders)
+                if (i.second == t && !applied[i.first])
+                    early = true;
+            ++applied[t];
+        }, threads);
+        REQUIRE(!early);
+        size_t nodes{};
+        for (unsigned i = 0; i < 60; ++i)
+        {
+            REQUIRE(applied[i] == (po.anyLeft(i) || po.anyRight(i)? 1: 0));
+            nodes += size_t(applied[i]);
+        }
+        CHECK(report.m_nodes == nodes);
+        CHECK(report.m_threads <= threads);
+        CHECK(report.m_totalCost == double(nodes));
+    }
+}
+
+TEST_CASE("Schedule the costliest chain first", "[S]")
+{
+    bux::C_PartialOrdering<char> po;
+    REQUIRE(po.addOrder('a', 'b'));
+    REQUIRE(po.addOrder('c', 'd'));
+    REQUIRE(po.addOrder('d', 'e'));
+    //-----------------------------
+    std::string out;
+    auto report = po.schedule([&](char c) { out += c; }, 1);
+    CHECK(out == "cadbe");
+    CHECK(report.m_criticalPath == 3);
+    CHECK(report.maxParallelism() == 5. / 3);
+    //-----------------------------
+    out.clear();
+    report = po.schedule([&](char c) { out += c; }, [](char c) { return c == 'b'? 10: 1; }, 1);
+    CHECK(out == "abcde");
+    CHECK(report.m_criticalPath == 11);
+    CHECK(report.m_totalCost == 14);
+}
+
+TEST_CASE("Stop scheduling when applying throws", "[E]")
+{
+    bux::C_PartialOrdering<int> po;
+    for (int i = 0; i < 20; ++i)
+        REQUIRE(po.addOrder(i, i + 1));
+    REQUIRE(po.addOrder(100, 101));
+    //-----------------------------
+    std::mutex lock;
+    std::vector<int> applied;
+    REQUIRE_THROWS_AS(po.schedule([&](int t) {
+        if (t == 5)
+            throw std::runtime_error{"Failed"};
+        std::scoped_lock _{lock};
+        applied.push_back(t);
+    }, 4), std::runtime_error);
+    for (auto i: applied)
+        CHECK((i < 5 || i >= 100));
+}
+
+TEST_CASE("Order 100k+ edges", "[.][benchmark]")
+{
+    constexpr unsigned NODES = 20000;
+    std::mt19937 rng{1};
+    bux::C_PartialOrdering<unsigned> po;
+    const auto start = std::chrono::steady_clock::now();
+    size_t orders{};
+    for (unsigned i = 0; i + 1 < NODES; ++i)
+        for (int j = 0; j < 6; ++j)
+        {
+            const auto to = j? i + 1 + unsigned(rng() % std::min(100U, NODES - 1 - i)): i + 1;
+            REQUIRE(po.addOrder(i, to));
+            ++orders;
+        }
+    const std::chrono::duration<double> added = std::chrono::steady_clock::now() - start;
+    REQUIRE(!po.addOrder(NODES - 1, 0U));
+    size_t linear{}, related{};
+    po.makeLinear([&](auto) { ++linear; });
+    po.getRelated(0U, [&](auto) { ++related; });
+    CHECK(linear == NODES);
+    CHECK(related == NODES - 1);
+    CHECK(po.depthToLeft(NODES - 1) > 0);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout <<orders <<" orders added in " <<added.count() <<"s and queried in " <<(elapsed - added).count() <<"s\n";
+}
+
+TEST_CASE("Query 100k relations", "[.][benchmark]")
+{
+    constexpr unsigned NODES = 1000;
+    for (auto maxClosureNodes: {0U, NODES})
+    {
+        std::mt19937 rng{1};
+        bux::C_PartialOrdering<unsigned> po{maxClosureNodes};
+        for (unsigned i = 0; i + 1 < NODES; ++i)
+            for (int j = 0; j < 3; ++j)
+                REQUIRE(po.addOrder(i, i + 1 + unsigned(rng() % std::min(100U, NODES - 1 - i))));
+
+        const auto start = std::chrono::steady_clock::now();
+        size_t related{};
+        for (int i = 0; i < 100000; ++i)
+            related += po.related(unsigned(rng() % NODES), unsigned(rng() % NODES));
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout <<related <<" related pairs found in " <<elapsed.count() <<"s with"
+                  <<(po.closureKept()? "": "out") <<" closure\n";
+    }
+}
+
+TEST_CASE("Schedule 2k nodes of 100us each", "[.][benchmark]")
+{
+    constexpr unsigned NODES = 2000;
+    std::mt19937 rng{1};
+    bux::C_PartialOrdering<unsigned> po;
+    for (unsigned i = 0; i + 1 < NODES; ++i)
+        for (int j = 0; j < 2; ++j)
+            REQUIRE(po.addOrder(i, i + 1 + unsigned(rng() % std::min(200U, NODES - 1 - i))));
+
+    const auto report = po.schedule([](unsigned) { std::this_thread::sleep_for(std::chrono::microseconds{100}); });
+    std::cout <<report.m_nodes <<" nodes scheduled on " <<report.m_threads <<" threads in " <<std::chrono::duration<double>(report.m_wallTime).count()
+              <<"s with parallelism " <<report.parallelism() <<" of " <<report.maxParallelism() <<" and " <<report.m_steals <<" steals\n";
+}
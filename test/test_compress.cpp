@@ -0,0 +1,164 @@
+/*
+    Test cases are organized according to ZOMBIES rules
+    http://blog.wingman-sw.com/tdd-guided-by-zombies
+*/
+#include <bux/Compress.h>   // bux::lz_compress(), bux::save_compressed_str(), ...
+#include <bux/MemIn.h>      // bux::C_IMemStream
+#include <bux/Serialize.h>  // bux::append_le()
+#include <cstdint>          // std::uint32_t, std::uint64_t
+#include <random>           // std::mt19937
+#include <sstream>          // std::ostringstream
+#include <string>           // std::string
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+//
+//      In-Module Functions
+//
+std::string textLike(size_t n)
+{
+    static const char *const WORDS[]{"alpha ", "beta ", "gamma ", "delta\n", "epsilon ", "zeta, "};
+    std::mt19937 rng{7};
+    std::string ret;
+    while (ret.size() < n)
+        ret += WORDS[rng() % std::size(WORDS)];
+    ret.resize(n);
+    return ret;
+}
+
+std::string noise(size_t n)
+{
+    std::mt19937 rng{11};
+    std::string ret(n, '\0');
+    for (auto &i: ret)
+        i = char(rng());
+    return ret;
+}
+
+bool roundTrip(const std::string &src)
+{
+    const auto packed = bux::lz_compress(src);
+    std::string dst(src.size(), '\0');
+    return bux::lz_decompress(packed, dst.data(), dst.size()) && dst == src;
+}
+
+std::tuple<std::string,bool> saveLoad(const std::string &src, size_t blockBytes, unsigned threads)
+{
+    std::ostringstream out;
+    bux::save_compressed_str(out, src, blockBytes, threads);
+    const auto saved = out.str();
+    bux::C_IMemStream in{saved};
+    return bux::load_compressed_str(in, threads);
+}
+
+} // namespace
+
+TEST_CASE("Compress nothing", "[Z]")
+{
+    CHECK(roundTrip({}));
+    const auto [s, ok] = saveLoad({}, 100, 0);
+    CHECK(ok);
+    CHECK(s.empty());
+}
+
+TEST_CASE("Codec round trips", "[O][M][B]")
+{
+    for (size_t n: {1, 12, 13, 16, 100, 65535, 65536, 200000})
+    {
+        CHECK(roundTrip(textLike(n)));
+        CHECK(roundTrip(noise(n)));
+        CHECK(roundTrip(std::string(n, 'a')));
+    }
+}
+
+TEST_CASE("Compressible text shrinks", "[M]")
+{
+    const auto src = textLike(1 << 20);
+    CHECK(bux::lz_compress(src).size() < src.size() / 2);
+    CHECK(bux::lz_compress(std::string(1 << 20, 'x')).size() < 5000);
+}
+
+TEST_CASE("Container round trips in parallel", "[I]")
+{
+    const auto src = textLike(3'000'000) + noise(100'000);
+    for (unsigned threads: {1, 4, 0})
+    {
+        const auto [s, ok] = saveLoad(src, 1 << 16, threads);
+        CHECK(ok);
+        CHECK(s == src);
+    }
+}
+
+TEST_CASE("Corrupt input is detected", "[E]")
+{
+    const auto src = textLike(100000);
+    auto packed = bux::lz_compress(src);
+    std::string dst(src.size(), '\0');
+    CHECK(!bux::lz_decompress(packed, dst.data(), dst.size() - 1));
+    CHECK(!bux::lz_decompress(std::string_view{packed}.substr(0, packed.size() / 2), dst.data(), dst.size()));
+    for (size_t i = 0; i < packed.size(); i += 97)
+    {
+        auto bad = packed;
+        bad[i] = char(~bad[i]);
+        bux::lz_decompress(bad, dst.data(), dst.size()); // Must not crash, whatever it returns
+    }
+
+    std::ostringstream out;
+    bux::save_compressed_str(out, src, 10000);
+    auto saved = out.str();
+    saved[saved.size() - 100] ^= 0x20;
+    {
+        bux::C_IMemStream in{saved};
+        CHECK(!std::get<1>(bux::load_compressed_str(in)));
+    }
+    saved.resize(saved.size() - 1);
+    {
+        bux::C_IMemStream in{saved};
+        CHECK(!std::get<1>(bux::load_compressed_str(in)));
+    }
+    {
+        bux::C_IMemStream in{"not compressed at all"};
+        CHECK(!std::get<1>(bux::load_compressed_str(in)));
+    }
+}
+
+TEST_CASE("Hostile sizes fail without allocating them", "[E]")
+{
+    const auto header = [](std::uint64_t total, std::uint32_t blockBytes, std::uint32_t blocks) {
+        std::string ret;
+        bux::append_le(std::uint32_t(0x7A585542), ret);
+        bux::append_le(std::uint32_t(1), ret);
+        bux::append_le(total, ret);
+        bux::append_le(blockBytes, ret);
+        bux::append_le(blocks, ret);
+        return ret;
+    };
+    const std::uint32_t BLOCK = 0x7FFF'FFFF;
+    for (auto &i: {
+        // 2^32-1 blocks claimed but no table
+        header(std::uint64_t(BLOCK) * 0xFFFF'FFFF, BLOCK, 0xFFFF'FFFF),
+        // Huge compressed blocks claimed but no payload
+        [&]{
+            auto ret = header(std::uint64_t(BLOCK) * 4, BLOCK, 4);
+            for (int j = 0; j < 4; ++j)
+            {
+                bux::append_le(BLOCK - 1, ret);
+                bux::append_le(std::uint64_t{}, ret);
+            }
+            return ret;
+        }(),
+        // Tiny compressed block claimed to expand to 2GB
+        [&]{
+            auto ret = header(BLOCK, BLOCK, 1);
+            bux::append_le(std::uint32_t(10), ret);
+            bux::append_le(std::uint64_t{}, ret);
+            return ret + std::string(10, '\0');
+        }()})
+    {
+        bux::C_IMemStream in{i};
+        const auto [s, ok] = bux::load_compressed_str(in);
+        CHECK(!ok);
+        CHECK(s.empty());
+    }
+}
@@ -0,0 +1,446 @@
+/*
+    Test cases are organized according to ZOMBIES rules
+    http://blog.wingman-sw.com/tdd-guided-by-zombies
+*/
+#include <bux/FA.h>         // bux::C_NFA<>, bux::C_DFA<>
+#include <bux/Intervals.h>  // bux::C_Intervals<>
+#include <algorithm>        // std::find_if()
+#include <chrono>           // std::chrono::steady_clock
+#include <iostream>         // std::cout
+#include <map>              // std::map<>
+#include <random>           // std::mt19937
+#include <set>              // std::set<>
+#include <string>           // std::string
+#include <string_view>      // std::string_view
+#include <thread>           // std::jthread
+#include <tuple>            // std::tuple<>
+#include <vector>           // std::vector<>
+#include <catch2/catch_test_macros.hpp>
+
+namespace bux {
+
+//
+//      Specialize Class Templates
+//
+template<>
+struct C_FA_Traits<C_Intervals<int>>
+{
+    static bool equalInput(const C_Intervals<int> &a, const C_Intervals<int> &b) { return a == b; }
+    static void inputDifference(C_Intervals<int> &dst, const C_Intervals<int> &src) { dst -= src; }
+    static void inputIntersection(C_Intervals<int> &dst, const C_Intervals<int> &src) { dst &= src; }
+    static void inputUnion(C_Intervals<int> &dst, const C_Intervals<int> &src) { dst |= src; }
+    static bool isEmptyInput(const C_Intervals<int> &src) { return src.empty(); }
+};
+
+} // namespace bux
+
+namespace {
+
+//
+//      In-Module Types
+//
+using C_Inputs  = bux::C_Intervals<int>;
+using C_NFA     = bux::C_NFA<C_Inputs,int>;
+using C_DFA     = bux::C_DFA<C_Inputs,int>;
+using C_LazyDFA = bux::C_LazyDFA<C_Inputs,int>;
+
+struct C_Matcher
+/*! Run a C_DFA over strings
+*/
+{
+    // Data
+    std::map<int,std::vector<std::pair<C_Inputs,int>>>  m_Delta;
+    std::set<int>                                       m_States;
+    const C_DFA                                         &m_DFA;
+
+    // Nonvirtuals
+    explicit C_Matcher(const C_DFA &dfa): m_DFA(dfa)
+    {
+        m_States.insert(dfa.startingState());
+        dfa.eachTransition([&](int from, const C_Inputs &inputs, int to) {
+            m_Delta[from].emplace_back(inputs, to);
+            m_States.insert(from);
+            m_States.insert(to);
+        });
+        dfa.eachFinalState([&](int state, int) { m_States.insert(state); });
+    }
+    int match(std::string_view s) const
+    /*! Return action of the final state reached by consuming all of s; 0 if not accepted.
+    */
+    {
+        int state = m_DFA.startingState();
+        for (auto c: s)
+        {
+            const auto found = m_Delta.find(state);
+            if (found == m_Delta.end())
+                return 0;
+
+            bool moved = false;
+            for (const auto &i: found->second)
+            {
+                C_Inputs t{c};
+                t &= i.first;
+                if (!t.empty())
+                {
+                    state = i.second;
+                    moved = true;
+                    break;
+                }
+            }
+            if (!moved)
+                return 0;
+        }
+        int action;
+        return m_DFA.isFinal(state, action)? action: 0;
+    }
+    size_t totalStates() const { return m_States.size(); }
+};
+
+//
+//      In-Module Functions
+//
+C_NFA word(std::string_view s)
+{
+    C_NFA ret;
+    for (auto c: s)
+        ret += C_Inputs{c};
+    return ret;
+}
+
+int pickFirst(int, const C_DFA::C_Conflict &conflict)
+{
+    return *conflict.begin();
+}
+
+int runByClass(auto &dfa, std::string_view s)
+/*! Return action of the final state reached by consuming all of s through input classes; 0 if not accepted.
+*/
+{
+    int state = dfa.startingState();
+    for (auto c: s)
+    {
+        const auto &classes = dfa.inputClasses();
+        const auto found = std::find_if(classes.begin(), classes.end(), [=](const C_Inputs &i) {
+            C_Inputs t{c};
+            t &= i;
+            return !t.empty();
+        });
+        if (found == classes.end() || (state = dfa.nextState(state, size_t(found - classes.begin()))) < 0)
+            return 0;
+    }
+    int action;
+    return dfa.isFinal(state, action)? action: 0;
+}
+
+C_NFA keywordsOverId()
+{
+    auto kwIf = word("if");
+    kwIf.setAction(1);
+    auto kwIn = word("in");
+    kwIn.setAction(2);
+    auto kwInt = word("int");
+    kwInt.setAction(3);
+    C_NFA id{C_Inputs{'a', 'z'}};
+    id.changeTo(bux::FA_REPEATABLE);
+    id.setAction(9);
+    C_NFA ret{kwIf};
+    ret |= kwIn;
+    ret |= kwInt;
+    ret |= id;
+    return ret;
+}
+
+std::vector<std::string> randomWords(unsigned seed, size_t count, unsigned letters)
+{
+    std::mt19937 rng{seed};
+    std::vector<std::string> ret;
+    while (ret.size() < count)
+    {
+        std::string w;
+        for (auto n = 1 + rng() % 8; n--;)
+            w += char('a' + rng() % letters);
+        ret.emplace_back(w);
+    }
+    return ret;
+}
+
+} // namespace
+
+TEST_CASE("Empty NFA", "[Z]")
+{
+    const C_DFA dfa{C_NFA{}, pickFirst};
+    CHECK(dfa.totalFinalStates() == 0);
+    CHECK(dfa.totalStates() == 1);
+    CHECK(C_Matcher{dfa}.totalStates() == 1);
+}
+
+TEST_CASE("Single word", "[O]")
+{
+    auto nfa = word("ab");
+    nfa.setAction(1);
+    const C_DFA dfa{nfa, pickFirst};
+    const C_Matcher m{dfa};
+    CHECK(m.totalStates() == 3);
+    CHECK(m.match("ab") == 1);
+    CHECK(m.match("a") == 0);
+    CHECK(m.match("abb") == 0);
+}
+
+TEST_CASE("Minimize (a|b)*abb", "[M]")
+{
+    C_NFA nfa{C_Inputs{'a'}};
+    nfa |= C_NFA{C_Inputs{'b'}};
+    nfa.changeTo(bux::FA_OPTIONAL|bux::FA_REPEATABLE);
+    nfa += word("abb");
+    nfa.setAction(1);
+    const C_DFA dfa{nfa, pickFirst};
+    const C_Matcher m{dfa};
+    CHECK(m.totalStates() == 4); // The textbook minimal DFA
+    CHECK(m.match("abb") == 1);
+    CHECK(m.match("babaabb") == 1);
+    CHECK(m.match("abba") == 0);
+    CHECK(m.match("") == 0);
+}
+
+TEST_CASE("Merge equivalent suffixes", "[M][B]")
+{
+    auto nfa = word("ab");
+    nfa |= word("cb");
+    nfa |= word("xyzb");
+    nfa.setAction(1);
+    const C_DFA dfa{nfa, pickFirst};
+    const C_Matcher m{dfa};
+    CHECK(m.totalStates() == 5); // start, {a,c,z}, x, y, final
+    CHECK(m.match("cb") == 1);
+    CHECK(m.match("xyzb") == 1);
+    CHECK(m.match("xb") == 0);
+}
+
+TEST_CASE("Reuse the same NFA", "[B]")
+{
+    auto a = word("ab");
+    auto nfa = a;
+    nfa += a;   // States shared with a are renamed
+    nfa |= a;
+    nfa.setAction(1);
+    const C_DFA dfa{nfa, pickFirst};
+    const C_Matcher m{dfa};
+    CHECK(dfa.totalStates() == m.totalStates());
+    CHECK(m.match("ab") == 1);
+    CHECK(m.match("abab") == 1);
+    CHECK(m.match("aba") == 0);
+    CHECK(m.match("ababab") == 0);
+}
+
+TEST_CASE("Keywords over identifier", "[I]")
+{
+    const C_DFA dfa{keywordsOverId(), pickFirst};
+    const C_Matcher m{dfa};
+    CHECK(m.match("if") == 1);
+    CHECK(m.match("in") == 2);
+    CHECK(m.match("int") == 3);
+    CHECK(m.match("i") == 9);
+    CHECK(m.match("into") == 9);
+    CHECK(m.match("x") == 9);
+    CHECK(m.match("1") == 0);
+    CHECK(dfa.totalFinalStates() == 5); // i, if, in, int & identifier
+}
+
+TEST_CASE("State IDs dense in each NFA", "[O][B]")
+{
+    C_NFA nfa;
+    CHECK(nfa.totalStates() == 1);
+    nfa = word("abc");
+    CHECK(nfa.totalStates() == 4);
+    nfa += nfa;
+    CHECK(nfa.totalStates() == 8);
+    nfa |= nfa;
+    CHECK(nfa.totalStates() == 16);
+    nfa.setAction(1);
+    const C_DFA dfa{nfa, pickFirst};
+    const C_Matcher m{dfa};
+    CHECK(m.match("abcabc") == 1);
+    CHECK(m.match("abc") == 0);
+
+    nfa.clear();
+    CHECK(nfa.totalStates() == 1);
+    CHECK(nfa.totalFinalStates() == 0);
+}
+
+TEST_CASE("Build NFAs concurrently", "[S]")
+{
+    std::vector<std::string> words{"if", "in", "int", "for", "while", "return"};
+    std::vector<std::vector<std::tuple<std::string,int>>> results(4);
+    {
+        std::vector<std::jthread> workers;
+        for (size_t i = 0; i < results.size(); ++i)
+            workers.emplace_back([&, i]{
+                C_NFA nfa;
+                for (size_t j = 0; j < words.size(); ++j)
+                {
+                    auto t = word(words[(i + j) % words.size()]);
+                    t.setAction(int((i + j) % words.size() + 1));
+                    nfa |= t;
+                }
+                const C_DFA dfa{nfa, pickFirst, 1};
+                const C_Matcher m{dfa};
+                for (const auto &w: words)
+                    results[i].emplace_back(w, m.match(w));
+            });
+    }
+    for (const auto &i: results)
+        CHECK(i == results.front());
+    for (size_t i = 0; i < words.size(); ++i)
+        CHECK(std::get<1>(results.front()[i]) == int(i + 1));
+}
+
+TEST_CASE("Dense table over input classes", "[I]")
+{
+    C_Inputs hexDigits{'0', '9'};
+    hexDigits |= C_Inputs{'a', 'f'};
+    C_NFA hex{hexDigits};
+    hex.changeTo(bux::FA_REPEATABLE);
+    hex.setAction(1);
+    C_NFA id{C_Inputs{'a', 'z'}};
+    id.changeTo(bux::FA_REPEATABLE);
+    id.setAction(2);
+    C_NFA nfa{hex};
+    nfa |= id;
+    const C_DFA dfa{nfa, pickFirst};
+    REQUIRE(dfa.totalClasses() == 3); // 0-9, a-f & g-z
+    REQUIRE(dfa.classTable().size() == dfa.totalStates() * dfa.totalClasses());
+
+    const C_Matcher m{dfa};
+    for (auto s: {"ff", "09", "fg", "g", "g9", "", "-"})
+        CHECK(runByClass(dfa, s) == m.match(s));
+    CHECK(runByClass(dfa, "c0ffee") == 1);
+    CHECK(runByClass(dfa, "coffee") == 2);
+}
+
+TEST_CASE("Lazy DFA agrees with DFA", "[O][M]")
+{
+    const auto nfa = keywordsOverId();
+    const C_DFA dfa{nfa, pickFirst};
+    C_LazyDFA lazy{nfa, pickFirst};
+    CHECK(lazy.cachedStates() == 1);
+    CHECK(lazy.totalClasses() == dfa.totalClasses());
+    for (const auto &i: randomWords(3, 500, 26))
+        CHECK(runByClass(lazy, i) == runByClass(dfa, i));
+    for (auto s: {"if", "in", "int", "i", "into", "", "1"})
+        CHECK(runByClass(lazy, s) == runByClass(dfa, s));
+    CHECK(lazy.flushes() == 0);
+    CHECK(lazy.cachedStates() >= dfa.totalStates());
+}
+
+TEST_CASE("Lazy DFA within tiny budget", "[B][E]")
+{
+    auto nfa = word("ab");
+    nfa.setAction(9);
+    for (const auto &i: randomWords(4, 200, 4))
+    {
+        auto t = word(i);
+        t.setAction(int(i.size()));
+        nfa |= t;
+    }
+    const C_DFA dfa{nfa, pickFirst};
+    C_LazyDFA lazy{nfa, pickFirst, 2048};
+    const auto words = randomWords(5, 2000, 4);
+    for (const auto &i: words)
+        CHECK(runByClass(lazy, i) == runByClass(dfa, i));
+    CHECK(lazy.flushes() > 0);
+    CHECK(lazy.cachedStates() < dfa.totalStates());
+}
+
+TEST_CASE("Lazy DFA keeps scanning after interrupted", "[E]")
+{
+    const auto nfa = keywordsOverId();
+    const C_DFA dfa{nfa, pickFirst};
+    int interrupts = 1;
+    C_LazyDFA lazy{nfa, [&](int state, const C_DFA::C_Conflict &conflict) {
+        return interrupts && interrupts--? 0: pickFirst(state, conflict);
+    }};
+    CHECK_THROWS_AS(runByClass(lazy, "if"), std::runtime_error);
+    CHECK(interrupts == 0);
+    for (auto s: {"if", "in", "int", "i", "into", "", "1"})
+        CHECK(runByClass(lazy, s) == runByClass(dfa, s));
+    for (const auto &i: randomWords(6, 500, 26))
+        CHECK(runByClass(lazy, i) == runByClass(dfa, i));
+}
+
+TEST_CASE("Same DFA from any number of threads", "[S]")
+{
+    std::mt19937 rng{2};
+    C_NFA nfa;
+    for (int i = 0; i < 400; ++i)
+    {
+        std::string w;
+        for (auto n = 2 + rng() % 6; n--;)
+            w += char('a' + rng() % 8);
+        auto t = word(w);
+        t.setAction(1 + i % 5);
+        nfa |= t;
+    }
+    C_NFA id{C_Inputs{'a', 'h'}};
+    id.changeTo(bux::FA_REPEATABLE);
+    id.setAction(9);
+    nfa |= id;
+
+    const auto dump = [](const C_DFA &dfa) {
+        std::vector<std::tuple<int,C_Inputs,int>> ret;
+        dfa.eachTransition([&](int from, const C_Inputs &inputs, int to) { ret.emplace_back(from, inputs, to); });
+        dfa.eachFinalState([&](int state, int action) { ret.emplace_back(state, C_Inputs{}, action); });
+        return ret;
+    };
+    const C_DFA serial{nfa, pickFirst, 1};
+    CHECK(serial.totalStates() > 100);
+    for (unsigned threads: {2U, 4U, 0U})
+        CHECK(dump(C_DFA{nfa, pickFirst, threads}) == dump(serial));
+}
+
+TEST_CASE("Lazy DFA over 10k+ states", "[.][benchmark]")
+{
+    std::mt19937 rng{1};
+    C_NFA nfa;
+    std::vector<std::string> words;
+    for (int i = 0; i < 3000; ++i)
+    {
+        std::string w;
+        for (auto n = 4 + rng() % 8; n--;)
+            w += char('a' + rng() % 26);
+        auto t = word(w);
+        t.setAction(1 + i % 7);
+        nfa |= t;
+        words.emplace_back(w);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    C_LazyDFA lazy{nfa, pickFirst, 1 << 20};
+    for (const auto &i: words)
+        CHECK(runByClass(lazy, i));
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout <<words.size() <<" words matched in " <<elapsed.count() <<"s with " <<lazy.cachedStates()
+              <<" states cached after " <<lazy.flushes() <<" flushes\n";
+}
+
+TEST_CASE("Minimize 10k+ states", "[.][benchmark]")
+{
+    std::mt19937 rng{1};
+    C_NFA nfa;
+    std::vector<std::string> words;
+    for (int i = 0; i < 3000; ++i)
+    {
+        std::string w;
+        for (auto n = 4 + rng() % 8; n--;)
+            w += char('a' + rng() % 26);
+        auto t = word(w);
+        t.setAction(1 + i % 7);
+        nfa |= t;
+        words.emplace_back(w);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const C_DFA dfa{nfa, pickFirst};
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const C_Matcher m{dfa};
+    std::cout <<m.totalStates() <<" DFA states in " <<elapsed.count() <<"s\n";
+    for (const auto &i: words)
+        CHECK(m.match(i));
+}
@@ -0,0 +1,166 @@
+/*
+    Test cases are organized according to ZOMBIES rules
+    http://blog.wingman-sw.com/tdd-guided-by-zombies
+*/
+#include <bux/FileAsMem.h>  // bux::C_FileAsMemory, bux::C_OFileAsMemory
+#include <bux/MemOut.h>     // bux::C_OMemStream
+#include <bux/Serialize.h>  // bux::append()
+#include <algorithm>        // std::min()
+#include <filesystem>       // std::filesystem::temp_directory_path()
+#include <fstream>          // std::ofstream
+#include <string>           // std::string
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+//
+//      In-Module Functions
+//
+auto createFile(const char *name, const std::string &content)
+{
+    auto ret = std::filesystem::temp_directory_path() / name;
+    std::ofstream{ret, std::ios::binary} <<content;
+    return ret;
+}
+
+std::string pattern(size_t n)
+{
+    std::string ret;
+    for (size_t i = 0; i < n; ++i)
+        ret += char('a' + i % 26);
+    return ret;
+}
+
+} // namespace
+
+TEST_CASE("Empty file", "[Z]")
+{
+    const auto path = createFile("test_fileasmem_empty", {});
+    const bux::C_FileAsMemory map{path};
+    CHECK(map.empty());
+    CHECK(map.size() == 0);
+    CHECK(map.view().empty());
+    CHECK(map.advise(bux::MA_WILLNEED));
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Whole file", "[O]")
+{
+    const auto content = pattern(12345);
+    const auto path = createFile("test_fileasmem_whole", content);
+    const bux::C_FileAsMemory map{path, bux::MA_SEQUENTIAL};
+    REQUIRE(map.size() == content.size());
+    CHECK(map.view() == content);
+    CHECK(map.span().size() == content.size());
+    CHECK(map.bytes().size() == content.size());
+    CHECK(map.offset() == 0);
+    CHECK(map.advise(bux::MA_RANDOM, 100, 200));
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Ranges of file", "[M][B]")
+{
+    const auto gran = bux::C_FileAsMemory::granularity();
+    const auto content = pattern(gran * 3 + 17);
+    const auto path = createFile("test_fileasmem_range", content);
+    for (size_t off: {size_t(0), size_t(1), gran - 1, gran, gran + 5, content.size() - 1, content.size()})
+    {
+        const bux::C_FileAsMemory map{path, off, gran};
+        CHECK(map.offset() == off);
+        CHECK(map.view() == content.substr(off, gran));
+    }
+    // Clipped to the end of file
+    const bux::C_FileAsMemory tail{path, gran * 3, bux::C_FileAsMemory::npos};
+    CHECK(tail.view() == content.substr(gran * 3));
+    CHECK_THROWS_AS((bux::C_FileAsMemory{path, content.size() + 1, 1}), std::out_of_range);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Move only", "[I]")
+{
+    const auto content = pattern(100);
+    const auto path = createFile("test_fileasmem_move", content);
+    bux::C_FileAsMemory a{path};
+    bux::C_FileAsMemory b{std::move(a)};
+    CHECK(a.empty());
+    CHECK(b.view() == content);
+    a = std::move(b);
+    CHECK(b.empty());
+    CHECK(a.view() == content);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Missing file", "[E]")
+{
+    CHECK_THROWS_AS(bux::C_FileAsMemory{std::filesystem::temp_directory_path() / "test_fileasmem_missing"}, std::system_error);
+}
+
+TEST_CASE("Write nothing", "[Z]")
+{
+    const auto path = std::filesystem::temp_directory_path() / "test_ofileasmem_empty";
+    {
+        bux::C_OFileAsMemory out{path, 12345};
+        CHECK(out.size() == 0);
+        CHECK(out.capacity() >= 12345);
+    }
+    CHECK(std::filesystem::file_size(path) == 0);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Move-assign finalizes the file written", "[I]")
+{
+    const auto pathA = std::filesystem::temp_directory_path() / "test_ofileasmem_a";
+    const auto pathB = std::filesystem::temp_directory_path() / "test_ofileasmem_b";
+    {
+        bux::C_OFileAsMemory a{pathA};
+        a.append(nullptr, 0);
+        a.append("abc", 3);
+        bux::C_OFileAsMemory b{pathB};
+        b.append("xy", 2);
+        a = std::move(b);
+        CHECK(bux::C_FileAsMemory{pathA}.view() == "abc");
+        CHECK(a.size() == 2);
+        CHECK(b.size() == 0);
+        b.append(nullptr, 0);
+    }
+    CHECK(bux::C_FileAsMemory{pathB}.view() == "xy");
+    std::filesystem::remove(pathA);
+    std::filesystem::remove(pathB);
+}
+
+TEST_CASE("Write and grow", "[M]")
+{
+    const auto path = std::filesystem::temp_directory_path() / "test_ofileasmem_grow";
+    const auto content = pattern(bux::C_FileAsMemory::granularity() * 5 + 3);
+    {
+        bux::C_OFileAsMemory out{path};
+        for (size_t i = 0; i < content.size(); i += 7)
+            out.append(content.data() + i, std::min<size_t>(7, content.size() - i));
+
+        CHECK(out.size() == content.size());
+        CHECK(out.capacity() >= content.size());
+        out.finalize();
+        out.finalize(); // Idempotent
+    }
+    CHECK(bux::C_FileAsMemory{path}.view() == content);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Write thru C_OMemStream & Serialize.h", "[I]")
+{
+    const auto path = std::filesystem::temp_directory_path() / "test_ofileasmem_stream";
+    std::string expected;
+    {
+        bux::C_OFileAsMemory out{path};
+        bux::C_OMemStream os{out.spare(100)};
+        os <<"Hello " <<42;
+        out.commit(os.size());
+        expected = "Hello 42";
+        bux::append(0x12345678U, out);
+        bux::append(0x12345678U, expected);
+        CHECK(out.size() == expected.size());
+        CHECK_THROWS_AS(out.commit(out.capacity()), std::out_of_range);
+    }
+    CHECK(bux::C_FileAsMemory{path}.view() == expected);
+    std::filesystem::remove(path);
+}
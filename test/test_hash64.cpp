@@ -0,0 +1,110 @@
+/*
+    Test cases are organized according to ZOMBIES rules
+    http://blog.wingman-sw.com/tdd-guided-by-zombies
+*/
+#include <bux/Hash64.h>     // bux::C_Hash64, bux::hash64()
+#include <bux/MemIn.h>      // bux::C_IMemStream
+#include <bux/Serialize.h>  // bux::load_hashed_str(), bux::save_hashed_str()
+#include <algorithm>        // std::min()
+#include <functional>       // std::hash<>
+#include <sstream>          // std::ostringstream
+#include <string>           // std::string
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+//
+//      In-Module Functions
+//
+std::string pattern(size_t n)
+{
+    std::string ret;
+    for (size_t i = 0; i < n; ++i)
+        ret += char(i * 131 + i / 7);
+    return ret;
+}
+
+} // namespace
+
+TEST_CASE("Hash nothing", "[Z]")
+{
+    CHECK(bux::hash64("") == 0xEF46DB3751D8E999ULL);
+    CHECK(bux::C_Hash64{}.digest() == bux::hash64(""));
+}
+
+TEST_CASE("Known XXH64 values", "[O][M]")
+{
+    CHECK(bux::hash64("a") == 0xD24EC4F1A98C6E5BULL);
+    CHECK(bux::hash64("abc") == 0x44BC2CF5AD770999ULL);
+    CHECK(bux::hash64("Nobody inspects the spammish repetition") == 0xFBCEA83C8A378BF1ULL);
+    CHECK(bux::hash64("abc", 1) != bux::hash64("abc"));
+}
+
+TEST_CASE("Streaming equals one-shot", "[I][B]")
+{
+    const auto s = pattern(1000);
+    for (size_t len: {0, 1, 31, 32, 33, 63, 64, 65, 999, 1000})
+        for (size_t piece: {1, 7, 32, 100})
+        {
+            bux::C_Hash64 h{42};
+            for (size_t i = 0; i < len; i += piece)
+                h.update(s.data() + i, std::min(piece, len - i));
+            CHECK(h.digest() == bux::hash64(s.data(), len, 42));
+        }
+}
+
+TEST_CASE("Save & load hashed string", "[I]")
+{
+    for (size_t n: {0, 5, (1 << 20) + 3})
+    {
+        const auto src = pattern(n);
+        std::ostringstream out;
+        const auto h = bux::save_hashed_str(out, src);
+        CHECK(h == size_t(bux::hash64(src)));
+        const auto saved = out.str();
+        CHECK(saved.size() == 24 + n);
+
+        bux::C_IMemStream in{saved};
+        const auto [s, hash, ok] = bux::load_hashed_str(in);
+        CHECK(ok);
+        CHECK(hash == h);
+        CHECK(s == src);
+    }
+}
+
+TEST_CASE("Load legacy hashed string", "[I]")
+{
+    const std::string src = "Saved by older versions";
+    const size_t h = std::hash<std::string>{}(src);
+    std::string saved{reinterpret_cast<const char*>(&h), sizeof h};
+    saved += src;
+    bux::C_IMemStream in{saved};
+    const auto [s, hash, ok] = bux::load_hashed_str(in);
+    CHECK(ok);
+    CHECK(hash == h);
+    CHECK(s == src);
+}
+
+TEST_CASE("Load corrupt or truncated hashed string", "[E]")
+{
+    std::ostringstream out;
+    bux::save_hashed_str(out, pattern(100));
+    auto saved = out.str();
+    saved[50] ^= 1;
+    {
+        bux::C_IMemStream in{saved};
+        CHECK(!std::get<2>(bux::load_hashed_str(in)));
+    }
+    saved[50] ^= 1;
+    saved.resize(saved.size() - 1);
+    {
+        bux::C_IMemStream in{saved};
+        const auto [s, hash, ok] = bux::load_hashed_str(in);
+        CHECK(!ok);
+        CHECK(s.size() == 99);
+    }
+    {
+        bux::C_IMemStream in{saved.data(), 10};
+        CHECK(!std::get<2>(bux::load_hashed_str(in)));
+    }
+}
@@ -0,0 +1,286 @@
+/*
+    Test cases are organized according to ZOMBIES rules
+    http://blog.wingman-sw.com/tdd-guided-by-zombies
+*/
+#include <bux/CodePointSet.h>   // bux::C_CodePointSet
+#include <bux/Intervals.h>  // bux::C_Intervals<>
+#include <algorithm>        // std::max(), std::min()
+#include <chrono>           // std::chrono::steady_clock
+#include <iostream>         // std::cout
+#include <limits>           // std::numeric_limits<>
+#include <memory>           // std::make_unique<>()
+#include <random>           // std::mt19937
+#include <set>              // std::set<>
+#include <stdexcept>        // std::invalid_argument, std::runtime_error
+#include <utility>          // std::pair<>
+#include <vector>           // std::vector<>
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+//
+//      In-Module Types
+//
+using C_Ints = bux::C_Intervals<int>;
+
+//
+//      In-Module Functions
+//
+auto valuesOf(const C_Ints &x)
+{
+    std::set<int> ret;
+    for (auto &i: x)
+        for (int t = i.first; t <= i.second; ++t)
+            ret.insert(t);
+    return ret;
+}
+
+bool isCanonical(const C_Ints &x)
+{
+    const C_Ints::value_type *prev{};
+    for (auto &i: x)
+    {
+        if (i.first > i.second || (prev && prev->second + 1 >= i.first))
+            return false;
+        prev = &i;
+    }
+    return true;
+}
+
+auto randomIntervals(std::mt19937 &rng, size_t count, int maxValue, int maxWidth)
+{
+    std::vector<C_Ints::value_type> ret;
+    for (auto i = count; i--;)
+    {
+        const auto a = int(rng() % unsigned(maxValue + 1));
+        ret.emplace_back(a, std::min(maxValue, a + int(rng() % unsigned(maxWidth))));
+    }
+    return ret;
+}
+
+} // namespace
+
+TEST_CASE("Empty intervals", "[Z]")
+{
+    C_Ints x;
+    CHECK(x.empty());
+    CHECK(!x.contains(0));
+    std::vector<int> v;
+    CHECK(C_Ints(v.begin(), v.end()).empty());
+    //------------------------------
+    x |= C_Ints{};
+    x &= C_Ints{3, 5};
+    x -= C_Ints{3, 5};
+    CHECK(x.empty());
+    //------------------------------
+    const int points[]{1, 2, 3};
+    bool found[3]{true, true, true};
+    x.contains(points, found);
+    CHECK((!found[0] && !found[1] && !found[2]));
+}
+
+TEST_CASE("One interval", "[O]")
+{
+    const C_Ints x{3, 5};
+    REQUIRE(x.size() == 1);
+    CHECK(!x.contains(2));
+    CHECK(x.contains(3));
+    CHECK(x.contains(5));
+    CHECK(!x.contains(6));
+}
+
+TEST_CASE("Build from unsorted values & intervals", "[M]")
+{
+    const std::vector<unsigned char> values{9, 3, 4, 200, 5, 3, 10, 7};
+    const bux::C_Intervals<unsigned> x(values.begin(), values.end());
+    const std::vector<std::pair<unsigned,unsigned>> expected{{3,5}, {7,7}, {9,10}, {200,200}};
+    CHECK(std::vector(x.begin(), x.end()) == expected);
+    //------------------------------
+    const std::vector<C_Ints::value_type> intervals{{20, 30}, {1, 2}, {3, 3}, {25, 40}, {41, 41}};
+    const C_Ints y(intervals.begin(), intervals.end());
+    const std::vector<C_Ints::value_type> merged{{1, 3}, {20, 41}};
+    CHECK(std::vector(y.begin(), y.end()) == merged);
+}
+
+TEST_CASE("Set operations agree with std::set", "[M][I]")
+{
+    std::mt19937 rng{1};
+    for (int round = 0; round < 2000; ++round)
+    {
+        const auto ia = randomIntervals(rng, rng() % 6, 60, 6), ib = randomIntervals(rng, rng() % 6, 60, 6);
+        const C_Ints a(ia.begin(), ia.end()), b(ib.begin(), ib.end());
+        REQUIRE(isCanonical(a));
+        const auto sa = valuesOf(a), sb = valuesOf(b);
+        std::set<int> su{sa}, sx, sd;
+        su.insert(sb.begin(), sb.end());
+        for (auto t: sa)
+            (sb.contains(t)? sx: sd).insert(t);
+
+        auto u = a;
+        u |= b;
+        CHECK(isCanonical(u));
+        CHECK(valuesOf(u) == su);
+        auto x = a;
+        x &= b;
+        CHECK(isCanonical(x));
+        CHECK(valuesOf(x) == sx);
+        auto d = a;
+        d -= b;
+        CHECK(isCanonical(d));
+        CHECK(valuesOf(d) == sd);
+        for (int t = -1; t <= 61; ++t)
+            REQUIRE(u.contains(t) == su.contains(t));
+    }
+}
+
+TEST_CASE("Coalesce at the boundaries", "[B]")
+{
+    constexpr auto MIN = std::numeric_limits<int>::min(), MAX = std::numeric_limits<int>::max();
+    C_Ints x{MAX - 1, MAX};
+    x |= C_Ints{MIN, MIN + 1};
+    x |= C_Ints{MAX - 3, MAX - 2};
+    const std::vector<C_Ints::value_type> expected{{MIN, MIN + 1}, {MAX - 3, MAX}};
+    CHECK(std::vector(x.begin(), x.end()) == expected);
+    CHECK(x.contains(MIN));
+    CHECK(x.contains(MAX));
+    CHECK(!x.contains(0));
+    //------------------------------
+    x -= C_Ints{MAX, MAX};
+    x -= C_Ints{MIN, MIN};
+    const std::vector<C_Ints::value_type> cut{{MIN + 1, MIN + 1}, {MAX - 3, MAX - 1}};
+    CHECK(std::vector(x.begin(), x.end()) == cut);
+}
+
+TEST_CASE("Batch membership", "[M]")
+{
+    std::mt19937 rng{2};
+    const auto ia = randomIntervals(rng, 300, 0x10FFFF, 100);
+    const C_Ints x(ia.begin(), ia.end());
+    std::vector<int> points(1001);
+    for (auto &i: points)
+        i = int(rng() % 0x110000);
+    for (auto &i: ia)
+        points.emplace_back(i.second);
+
+    for (int sorted = 0; sorted < 2; ++sorted)
+    {
+        if (sorted)
+            std::sort(points.begin(), points.end());
+
+        const auto found = std::make_unique<bool[]>(points.size());
+        x.contains(points, {found.get(), points.size()});
+        for (size_t i = 0; i < points.size(); ++i)
+            REQUIRE(found[i] == x.contains(points[i]));
+    }
+}
+
+TEST_CASE("Invalid intervals", "[E]")
+{
+    CHECK_THROWS_AS(C_Ints(5, 3), std::runtime_error);
+    const std::vector<C_Ints::value_type> intervals{{1, 2}, {5, 3}};
+    CHECK_THROWS_AS(C_Ints(intervals.begin(), intervals.end()), std::runtime_error);
+    //------------------------------
+    const C_Ints x{1, 2};
+    const int points[]{1, 2};
+    bool found[1];
+    CHECK_THROWS_AS(x.contains(points, found), std::invalid_argument);
+}
+
+TEST_CASE("Empty code point set", "[Z]")
+{
+    const bux::C_CodePointSet x;
+    CHECK(x.toIntervals().empty());
+    for (char32_t c: {U'\0', U'a', U'\x80', U'\x10FFFF', char32_t(0x110000)})
+        CHECK(!x.contains(c));
+}
+
+TEST_CASE("Code point set agrees with intervals", "[M][I]")
+{
+    std::mt19937 rng{3};
+    for (int round = 0; round < 20; ++round)
+    {
+        auto ia = randomIntervals(rng, 1 + rng() % 1000, 0x10FFFF, 1 + int(rng() % 300));
+        ia.emplace_back(int(rng() % 128), int(rng() % 128 + 128));
+        const C_Ints x(ia.begin(), ia.end());
+        const bux::C_CodePointSet y{x};
+        const auto back = y.toIntervals();
+        REQUIRE(std::vector<C_Ints::value_type>(back.begin(), back.end()) == std::vector(x.begin(), x.end()));
+        for (int i = 0; i < 10000; ++i)
+        {
+            const auto c = rng() % 0x110000;
+            REQUIRE(y.contains(char32_t(c)) == x.contains(int(c)));
+        }
+        for (auto &i: x)
+        {
+            REQUIRE(y.contains(char32_t(i.first)));
+            REQUIRE(y.contains(char32_t(i.second)));
+            REQUIRE((!i.first || !y.contains(char32_t(i.first - 1))));
+            REQUIRE((i.second == 0x10FFFF || !y.contains(char32_t(i.second + 1))));
+        }
+    }
+}
+
+TEST_CASE("Code points out of range", "[B]")
+{
+    const C_Ints x{-100, 0x20FFFF};
+    const bux::C_CodePointSet y{x};
+    CHECK(y.contains(0));
+    CHECK(y.contains(0x10FFFF));
+    CHECK(!y.contains(0x110000));
+    const auto back = y.toIntervals();
+    REQUIRE(back.size() == 1);
+    CHECK(*back.begin() == std::pair<std::uint32_t,std::uint32_t>(0, 0x10FFFF));
+    CHECK(y.bytes() < 2048);
+}
+
+TEST_CASE("Unicode-category-sized sets", "[.][benchmark]")
+{
+    typedef std::chrono::steady_clock C_Clock;
+    std::mt19937 rng{1};
+    std::vector<unsigned> codePoints;
+    for (auto &i: randomIntervals(rng, 700, 0x10FFFF, 40))
+        for (auto j = unsigned(i.first); j <= unsigned(i.second); ++j)
+            codePoints.emplace_back(j);
+
+    auto start = C_Clock::now();
+    const bux::C_Intervals<unsigned> x(codePoints.begin(), codePoints.end());
+    const std::chrono::duration<double> built = C_Clock::now() - start;
+
+    std::vector<unsigned> points(1 << 20);
+    for (auto &i: points)
+        i = unsigned(rng() % 0x110000);
+    const auto found = std::make_unique<bool[]>(points.size());
+    start = C_Clock::now();
+    x.contains(points, {found.get(), points.size()});
+    const std::chrono::duration<double> batched = C_Clock::now() - start;
+
+    size_t hits{};
+    start = C_Clock::now();
+    for (auto i: points)
+        hits += x.contains(i);
+    const std::chrono::duration<double> single = C_Clock::now() - start;
+
+    const bux::C_CodePointSet trie{x};
+    size_t trieHits{};
+    start = C_Clock::now();
+    for (auto i: points)
+        trieHits += trie.contains(i);
+    const std::chrono::duration<double> lookedUp = C_Clock::now() - start;
+    CHECK(trieHits == hits);
+
+    auto y = x;
+    start = C_Clock::now();
+    for (int i = 0; i < 100; ++i)
+    {
+        y |= x;
+        y -= x;
+        y |= x;
+        y &= x;
+    }
+    const std::chrono::duration<double> ops = C_Clock::now() - start;
+    CHECK(y == x);
+    std::cout <<codePoints.size() <<" code points into " <<x.size() <<" intervals in " <<built.count() <<"s\n"
+              <<points.size() <<" points tested in " <<batched.count() <<"s batched, " <<single.count() <<"s one by one, "
+              <<lookedUp.count() <<"s by " <<trie.bytes() <<" bytes of trie, "
+              <<hits <<" hits\n400 set operations in " <<ops.count() <<"s\n";
+}
@@ -2,10 +2,53 @@
     Test cases are organized according to ZOMBIES rules
     http://blog.wingman-sw.com/tdd-guided-by-zombies
 */
-#include <bux/LexBase.h>    // bux::asciiLiteral()
+#include <bux/LexBase.h>    // bux::asciiLiteral(), bux::C_LexArena, bux::createLex<>()
+#include <bux/XAutoPtr.h>   // bux::C_AutoNode<>, bux::C_NewNode<>
 //#include <bux/UnicodeCvt.h> // bux::BOM()
+#include <chrono>           // std::chrono::steady_clock
+#include <cstdint>          // std::uintptr_t
+#include <iostream>         // std::cout
+#include <optional>         // std::optional<>
+#include <stdexcept>        // std::runtime_error
+#include <string>           // std::string
+#include <thread>           // std::jthread
+#include <vector>           // std::vector<>
 #include <catch2/catch_test_macros.hpp>
 
+namespace {
+
+//
+//      In-Module Types
+//
+struct C_CountedLex: bux::I_LexAttr
+{
+    // Data
+    static inline int   m_Live{};
+    std::string         m_Str;
+
+    // Nonvirtuals
+    explicit C_CountedLex(std::string s): m_Str(std::move(s)) { ++m_Live; }
+    C_CountedLex(const C_CountedLex &other): I_LexAttr(other), m_Str(other.m_Str) { ++m_Live; }
+    ~C_CountedLex() override { --m_Live; }
+};
+
+struct alignas(64) C_AlignedLex: bux::I_LexAttr
+{
+    // Data
+    char                m_Bytes[64]{};
+};
+
+struct C_ThrowingLex: bux::I_LexAttr
+{
+    // Data
+    C_CountedLex        m_Counted{"partial"};
+
+    // Nonvirtuals
+    C_ThrowingLex() { throw std::runtime_error{"Not made"}; }
+};
+
+} // namespace
+
 TEST_CASE("Regression errors", "[S]")
 {
     CHECK(bux::asciiLiteral("::") == "::");
@@ -21,3 +64,130 @@ TEST_CASE("Expectations", "[S]")
     CHECK(bux::asciiLiteral((const char*)u8"\u1234") == (const char*)u8"\u1234");
     CHECK(bux::asciiLiteral((const char*)u8"\uABCD") == (const char*)u8"\uABCD");
 }
+
+TEST_CASE("Lexes from the heap without arena", "[Z]")
+{
+    REQUIRE(!bux::C_LexArena::current());
+    const auto p = bux::createLex<std::string>("abc");
+    CHECK(p->m_data == "abc");
+    delete p;
+}
+
+TEST_CASE("Lexes carved out of arena", "[O][M]")
+{
+    bux::C_LexArena arena;
+    REQUIRE(bux::C_LexArena::current() == &arena);
+    {
+        bux::C_AutoNode<bux::I_LexAttr> a{new C_CountedLex{std::string(100, 'a')}, true};
+        const bux::C_NewNode<C_CountedLex> b{"b"};
+        CHECK(C_CountedLex::m_Live == 2);
+        CHECK(arena.allocations() == 2);
+        CHECK(arena.bytes() == 2 * sizeof(C_CountedLex));
+    }
+    // Destructors run by the owners as usual
+    CHECK(C_CountedLex::m_Live == 0);
+    //------------------------------
+    const auto aligned = new C_AlignedLex;
+    CHECK(reinterpret_cast<std::uintptr_t>(aligned) % 64 == 0);
+    CHECK(arena.allocations() == 2);
+    delete aligned;
+}
+
+TEST_CASE("Lexes outliving their arena", "[I]")
+{
+    bux::C_AutoNode<bux::I_LexAttr> kept;
+    {
+        bux::C_LexArena arena;
+        kept.reset(bux::createLex<std::string>(std::string(1000, 'x')));
+        delete bux::createLex<std::string>("temp");
+    }
+    REQUIRE(!bux::C_LexArena::current());
+    CHECK(dynamic_cast<bux::C_LexDataT<std::string>&>(*kept).m_data == std::string(1000, 'x'));
+}
+
+TEST_CASE("Nested arenas", "[B]")
+{
+    bux::C_LexArena outer;
+    delete bux::createLex<int>(1);
+    {
+        bux::C_LexArena inner;
+        REQUIRE(bux::C_LexArena::current() == &inner);
+        delete bux::createLex<int>(2);
+        delete bux::createLex<int>(3);
+        CHECK(inner.allocations() == 2);
+    }
+    REQUIRE(bux::C_LexArena::current() == &outer);
+    CHECK(outer.allocations() == 1);
+}
+
+TEST_CASE("Lexes deleted by other threads", "[S]")
+{
+    std::vector<bux::I_LexAttr*> lexes;
+    {
+        bux::C_LexArena arena;
+        for (int i = 0; i < 1000; ++i)
+            lexes.emplace_back(bux::createLex<std::string>(std::to_string(i)));
+    }
+    char inArena[4]{};
+    {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&, t] {
+                inArena[t] = bux::C_LexArena::current() != nullptr;
+                for (size_t i = size_t(t); i < lexes.size(); i += 4)
+                    delete lexes[i];
+            });
+    }
+    for (auto i: inArena)
+        CHECK(!i);
+}
+
+TEST_CASE("Copies of lexes in and out of arena", "[I]")
+{
+    const C_CountedLex onStack{"stack"};
+    C_CountedLex *heap{};
+    {
+        bux::C_LexArena arena;
+        const C_CountedLex alsoOnStack{"stack"};
+        const auto carved = new C_CountedLex{onStack};
+        heap = new C_CountedLex{alsoOnStack};
+        CHECK(arena.allocations() == 2);
+        delete heap;
+        heap = new C_CountedLex{*carved};
+        delete carved;
+    }
+    // Neither copy remembers the arena of its source
+    const auto copy = new C_CountedLex{*heap};
+    delete heap;
+    CHECK(copy->m_Str == "stack");
+    delete copy;
+    CHECK(C_CountedLex::m_Live == 1);
+}
+
+TEST_CASE("Constructor throwing in arena", "[E]")
+{
+    bux::C_LexArena arena;
+    CHECK_THROWS_AS(new C_ThrowingLex, std::runtime_error);
+    CHECK(arena.allocations() == 1);
+    CHECK(C_CountedLex::m_Live == 0);
+    delete bux::createLex<int>(1);
+    CHECK(arena.allocations() == 2);
+}
+
+TEST_CASE("Carve 1M lexes", "[.][benchmark]")
+{
+    for (int useArena = 0; useArena < 2; ++useArena)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        {
+            std::optional<bux::C_LexArena> arena;
+            if (useArena)
+                arena.emplace();
+            std::vector<bux::C_AutoNode<bux::I_LexAttr>> lexes(1 << 20);
+            for (auto &i: lexes)
+                i.reset(bux::createLex<long>(42L));
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout <<(1 << 20) <<" lexes made & freed in " <<elapsed.count() <<"s " <<(useArena? "with": "without") <<" arena\n";
+    }
+}
@@ -0,0 +1,830 @@
+/*
+    Test cases are organized according to ZOMBIES rules
+    http://blog.wingman-sw.com/tdd-guided-by-zombies
+*/
+#include <bux/ImplLR1.h>    // bux::LR1::FC_GetRelLex
+#include <bux/LR1.h>        // bux::LR1::C_Parser, bux::LR1::C_ParserT<>, bux::LR1::C_Checkpoints
+#include <bux/ParserBase.h> // bux::C_CombBuilder<>, bux::index2value<>()
+#include <algorithm>        // std::sort()
+#include <chrono>           // std::chrono::steady_clock
+#include <iostream>         // std::cout
+#include <optional>         // std::optional<>
+#include <random>           // std::mt19937
+#include <stdexcept>        // std::runtime_error, std::invalid_argument, std::out_of_range
+#include <string>           // std::string
+#include <vector>           // std::vector<>
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+//
+//      In-Module Constants
+//
+/*  SLR(1) tables of the grammar:
+
+        0: <@> -> E
+        1: E -> E '+' T
+        2: E -> T
+        3: T -> 'n'
+
+    and of the grammar keeping list items apart on the stack:
+
+        0: <@> -> L
+        1: L -> P ';' L
+        2: L -> P
+        3: P -> P '+' 'n'
+        4: P -> 'n'
+*/
+enum: bux::T_LexID
+{
+    NID_E       = bux::TOKENGEN_LB,
+    NID_T,
+    NID_L,
+    NID_P,
+    TID_ERROR
+};
+constexpr auto NO_STATE = bux::C_CombTable<bux::T_StateID>::NO_STATE;
+
+//
+//      In-Module Functions
+//
+size_t sumAction(bux::T_StateID state, bux::T_LexID token)
+{
+    switch (state)
+    {
+    case 0:
+    case 4:
+        if (token == 'n')
+            return bux::LR1::ACTION_SHIFT;
+        break;
+    case 1:
+        if (token == bux::TID_EOF)
+            return bux::LR1::ACTION_ACCEPT;
+        if (token == '+')
+            return bux::LR1::ACTION_SHIFT;
+        break;
+    case 2:
+    case 3:
+    case 5:
+        if (token == '+' || token == bux::TID_EOF)
+            return bux::LR1::ACTION_REDUCE_MIN + (state == 5? 1: state);
+        break;
+    }
+    return bux::LR1::ACTION_ERROR;
+}
+
+bux::T_StateID sumGoto(bux::T_StateID state, bux::T_LexID lex)
+{
+    switch (state)
+    {
+    case 0:
+        switch (lex)
+        {
+        case 'n':   return 3;
+        case NID_E: return 1;
+        case NID_T: return 2;
+        }
+        break;
+    case 1:
+        if (lex == '+')
+            return 4;
+        break;
+    case 4:
+        switch (lex)
+        {
+        case 'n':   return 3;
+        case NID_T: return 5;
+        }
+        break;
+    }
+    return NO_STATE;
+}
+
+bux::T_StateID sumNextState(bux::T_StateID state, bux::T_LexID lex)
+{
+    const auto ret = sumGoto(state, lex);
+    if (ret == NO_STATE)
+        throw std::runtime_error{"No goto from state " + std::to_string(state)};
+
+    return ret;
+}
+
+size_t listAction(bux::T_StateID state, bux::T_LexID token)
+{
+    switch (state)
+    {
+    case 0:
+    case 4:
+    case 5:
+        if (token == 'n')
+            return bux::LR1::ACTION_SHIFT;
+        break;
+    case 1:
+        if (token == bux::TID_EOF)
+            return bux::LR1::ACTION_ACCEPT;
+        break;
+    case 2:
+        if (token == ';' || token == '+')
+            return bux::LR1::ACTION_SHIFT;
+        if (token == bux::TID_EOF)
+            return bux::LR1::ACTION_REDUCE_MIN + 2;
+        break;
+    case 3:
+    case 7:
+        if (token == ';' || token == '+' || token == bux::TID_EOF)
+            return bux::LR1::ACTION_REDUCE_MIN + (state == 3? 4: 3);
+        break;
+    case 6:
+        if (token == bux::TID_EOF)
+            return bux::LR1::ACTION_REDUCE_MIN + 1;
+        break;
+    }
+    return bux::LR1::ACTION_ERROR;
+}
+
+bux::T_StateID listNextState(bux::T_StateID state, bux::T_LexID lex)
+{
+    switch (state)
+    {
+    case 0:
+    case 4:
+        switch (lex)
+        {
+        case 'n':   return 3;
+        case NID_L: return state == 0? 1: 6;
+        case NID_P: return 2;
+        }
+        break;
+    case 2:
+        switch (lex)
+        {
+        case ';':   return 4;
+        case '+':   return 5;
+        }
+        break;
+    case 5:
+        if (lex == 'n')
+            return 7;
+        break;
+    }
+    throw std::runtime_error{"No goto from state " + std::to_string(state)};
+}
+
+template<class T_Value, class F_Value>
+auto combOf(bux::T_LexID charSpan, std::initializer_list<bux::T_LexID> keys, F_Value value, T_Value error)
+{
+    bux::C_CombBuilder<T_Value> ret{charSpan, 1};
+    for (bux::T_StateID state = 0; state < 6; ++state)
+    {
+        std::vector<bux::C_KVPair<bux::T_LexID,T_Value>> row;
+        for (auto key: keys)
+            if (const auto t = value(state, key); t != error)
+                row.push_back({key, t});
+        ret.addRow(state, row.data(), row.size());
+    }
+    return ret;
+}
+
+size_t combAction(bux::T_StateID state, bux::T_LexID token)
+{
+    static const auto comb = combOf<size_t>(128, {'+', 'n', bux::TID_EOF}, sumAction, bux::LR1::ACTION_ERROR);
+    static const auto table = comb.table();
+    return table.lookup(state, token, bux::LR1::ACTION_ERROR);
+}
+
+bux::T_StateID combNextState(bux::T_StateID state, bux::T_LexID lex)
+{
+    static const auto comb = combOf<bux::T_StateID>(128, {'+', 'n', NID_E, NID_T}, sumGoto, NO_STATE);
+    static const auto table = comb.table();
+    const auto ret = table.lookup(state, lex, NO_STATE);
+    if (ret == NO_STATE)
+        throw std::runtime_error{"No goto from state " + std::to_string(state)};
+
+    return ret;
+}
+
+template<class F_Args>
+void reducePass(const F_Args &args, bux::LR1::C_LexPtr &ret)
+{
+    ret = args(0).m_attr;
+}
+
+template<class F_Args>
+void reduceAdd(const F_Args &args, bux::LR1::C_LexPtr &ret)
+{
+    ret.assign(bux::createLex<long>(bux::unlex<long>(args(0)) + bux::unlex<long>(args(2))), true);
+}
+
+template<class F_Args>
+void reduceAddNum(const F_Args &args, bux::LR1::C_LexPtr &ret)
+{
+    ret.assign(bux::createLex<long>(bux::unlex<long>(args(0)) + bux::unlex<int>(args(2))), true);
+}
+
+template<class F_Args>
+void reduceNum(const F_Args &args, bux::LR1::C_LexPtr &ret)
+{
+    ret.assign(bux::createLex<long>(long(bux::unlex<int>(args(0)))), true);
+}
+
+//
+//      In-Module Types
+//
+struct C_SumPolicy: bux::LR1::I_ParserPolicy
+{
+    // Ctor
+    C_SumPolicy(): I_ParserPolicy(TID_ERROR) {}
+
+    // Implement I_ParserPolicy
+    size_t action(bux::T_StateID state, bux::T_LexID token) const override
+    {
+        return sumAction(state, token);
+    }
+    size_t getAcceptId() const override { return 0; }
+    bux::T_StateID nextState(bux::T_StateID state, bux::T_LexID lex) const override
+    {
+        return sumNextState(state, lex);
+    }
+    void getReduceInfo(size_t id, C_ReduceInfo &info) const override
+    {
+        static const C_ReduceInfo REDUCTIONS[]{
+            {1, bux::ROOT_NID,  [](auto&, auto &args, auto &ret) { reducePass(args, ret); }},
+            {3, NID_E,          [](auto&, auto &args, auto &ret) { reduceAdd(args, ret); }},
+            {1, NID_E,          [](auto&, auto &args, auto &ret) { reducePass(args, ret); }},
+            {1, NID_T,          [](auto&, auto &args, auto &ret) { reduceNum(args, ret); }}
+        };
+        info = REDUCTIONS[id];
+    }
+    void onError(bux::LR1::C_Parser&, const bux::C_SourcePos &pos, std::string_view message) const override
+    {
+        throw std::runtime_error{std::to_string(pos.m_Col) + ": " + std::string{message}};
+    }
+};
+
+struct C_SwitchTables
+{
+    static size_t action(bux::T_StateID state, bux::T_LexID token) { return sumAction(state, token); }
+    static bux::T_StateID nextState(bux::T_StateID state, bux::T_LexID lex) { return sumNextState(state, lex); }
+};
+
+struct C_CombTables
+{
+    static size_t action(bux::T_StateID state, bux::T_LexID token) { return combAction(state, token); }
+    static bux::T_StateID nextState(bux::T_StateID state, bux::T_LexID lex) { return combNextState(state, lex); }
+};
+
+template<class T_Tables>
+struct C_SumStaticPolicyT: T_Tables
+{
+    // Types
+    typedef bux::LR1::C_ParserT<C_SumStaticPolicyT> C_Parser;
+
+    // Class Constants
+    static constexpr bux::T_LexID ID_ERROR = TID_ERROR;
+    static constexpr size_t ACCEPT_ID = 0;
+    static constexpr bux::LR1::C_ReductionT<C_Parser> REDUCTIONS[]{
+        {1, bux::ROOT_NID,  [](C_Parser&, auto &args, auto &ret) { reducePass(args, ret); }},
+        {3, NID_E,          [](C_Parser&, auto &args, auto &ret) { reduceAdd(args, ret); }},
+        {1, NID_E,          [](C_Parser&, auto &args, auto &ret) { reducePass(args, ret); }},
+        {1, NID_T,          [](C_Parser&, auto &args, auto &ret) { reduceNum(args, ret); }}
+    };
+
+    // Nonvirtuals
+    static void onError(C_Parser&, const bux::C_SourcePos &pos, std::string_view message)
+    {
+        throw std::runtime_error{std::to_string(pos.m_Col) + ": " + std::string{message}};
+    }
+};
+
+struct C_CloneablePolicy: C_SumPolicy
+{
+    // Implement I_ParserPolicy
+    bool cloneLex(const bux::LR1::C_LexPtr &src, bux::LR1::C_LexPtr &dst) const override
+    {
+        if (!src)
+            dst.clear();
+        else if (auto p = bux::tryUnlex<long>(src))
+            dst.assign(bux::createLex<long>(*p), true);
+        else if (auto q = bux::tryUnlex<int>(src))
+            dst.assign(bux::createLex<int>(*q), true);
+        else
+            return false;
+
+        return true;
+    }
+};
+
+struct C_ListPolicy: C_CloneablePolicy
+{
+    // Implement I_ParserPolicy
+    size_t action(bux::T_StateID state, bux::T_LexID token) const override
+    {
+        return listAction(state, token);
+    }
+    bux::T_StateID nextState(bux::T_StateID state, bux::T_LexID lex) const override
+    {
+        return listNextState(state, lex);
+    }
+    void getReduceInfo(size_t id, C_ReduceInfo &info) const override
+    {
+        static const C_ReduceInfo REDUCTIONS[]{
+            {1, bux::ROOT_NID,  [](auto&, auto &args, auto &ret) { reducePass(args, ret); }},
+            {3, NID_L,          [](auto&, auto &args, auto &ret) { reduceAdd(args, ret); }},
+            {1, NID_L,          [](auto&, auto &args, auto &ret) { reducePass(args, ret); }},
+            {3, NID_P,          [](auto&, auto &args, auto &ret) { reduceAddNum(args, ret); }},
+            {1, NID_P,          [](auto&, auto &args, auto &ret) { reduceNum(args, ret); }}
+        };
+        info = REDUCTIONS[id];
+    }
+};
+
+using C_SumStaticPolicy = C_SumStaticPolicyT<C_SwitchTables>;
+using C_SumCombPolicy = C_SumStaticPolicyT<C_CombTables>;
+
+struct C_ActionTraits
+{
+    static size_t map(long valOrSz, int ind) { return size_t(valOrSz + ind); }
+    static size_t valueError() { return bux::LR1::ACTION_ERROR; }
+};
+
+//
+//      In-Module Functions
+//
+template<class C_Parser>
+long sumOf(C_Parser &parser, size_t terms)
+{
+    unsigned col{};
+    for (size_t i = 0; i < terms; ++i)
+    {
+        if (i)
+            parser.add('+', 1, ++col, nullptr);
+        parser.add('n', 1, ++col, bux::createLex<int>(int(i % 10)));
+    }
+    parser.add(bux::TID_EOF, 1, ++col, nullptr);
+    REQUIRE(parser.accepted());
+    return bux::unlex<long>(parser.getFinalLex());
+}
+
+auto sumTokens(size_t terms)
+{
+    std::vector<std::pair<bux::T_LexID,int>> ret;
+    for (size_t i = 0; i < terms; ++i)
+    {
+        if (i)
+            ret.emplace_back('+', 0);
+        ret.emplace_back('n', int(i % 10));
+    }
+    return ret;
+}
+
+auto listTokens(size_t items, size_t width)
+{
+    std::vector<std::pair<bux::T_LexID,int>> ret;
+    for (size_t i = 0; i < items; ++i)
+    {
+        if (i)
+            ret.emplace_back(';', 0);
+        for (size_t j = 0; j < width; ++j)
+        {
+            if (j)
+                ret.emplace_back('+', 0);
+            ret.emplace_back('n', int((i + j) % 10));
+        }
+    }
+    return ret;
+}
+
+size_t addTokens(bux::LR1::C_Parser &parser, const std::vector<std::pair<bux::T_LexID,int>> &tokens, size_t from,
+    bux::LR1::C_Checkpoints *checkpoints = nullptr)
+{
+    for (auto i = from; i < tokens.size(); ++i)
+    {
+        auto &t = tokens[i];
+        parser.add(t.first, 1, unsigned(i + 1), t.first == 'n'? bux::createLex<int>(t.second): nullptr);
+        if (checkpoints && checkpoints->onAdded(parser))
+            // Converged
+            return i + 1 - from;
+    }
+    return tokens.size() - from;
+}
+
+long finish(bux::LR1::C_Parser &parser)
+{
+    parser.add(bux::TID_EOF, 1, unsigned(parser.tokens() + 1), nullptr);
+    REQUIRE(parser.accepted());
+    return bux::unlex<long>(parser.getFinalLex());
+}
+
+} // namespace
+
+TEST_CASE("Parse the shortest sentence", "[O]")
+{
+    const C_SumPolicy policy;
+    bux::LR1::C_Parser virtualParser{policy};
+    CHECK(sumOf(virtualParser, 1) == 0);
+    C_SumStaticPolicy::C_Parser staticParser;
+    CHECK(sumOf(staticParser, 1) == 0);
+}
+
+TEST_CASE("Template parser agrees with virtual parser", "[M]")
+{
+    const C_SumPolicy policy;
+    for (size_t terms: {2, 3, 10, 1000})
+    {
+        bux::LR1::C_Parser virtualParser{policy};
+        C_SumStaticPolicy::C_Parser staticParser;
+        C_SumCombPolicy::C_Parser combParser;
+        const auto sum = sumOf(virtualParser, terms);
+        CHECK(sumOf(staticParser, terms) == sum);
+        CHECK(sumOf(combParser, terms) == sum);
+        long expected{};
+        for (size_t i = 0; i < terms; ++i)
+            expected += long(i % 10);
+        CHECK(sum == expected);
+    }
+}
+
+TEST_CASE("Syntax error reaches the policy", "[E]")
+{
+    C_SumStaticPolicy::C_Parser parser;
+    parser.add('n', 1, 1, bux::createLex<int>(1));
+    CHECK_THROWS_AS(parser.add('n', 1, 2, bux::createLex<int>(2)), std::runtime_error);
+    //------------------------------
+    C_SumStaticPolicy::C_Parser parser2;
+    CHECK_THROWS_AS(parser2.add(bux::TID_EOF, 1, 1, nullptr), std::runtime_error);
+}
+
+TEST_CASE("Produced symbols by reference", "[S]")
+{
+    bux::LR1::C_StateLR1 popped[3];
+    for (int i = 0; i < 3; ++i)
+        popped[i].m_attr.assign(bux::createLex<int>(i * 10), true);
+
+    const bux::LR1::C_Produced produced{popped, 3, 7};
+    const bux::LR1::F_GetProducedRef args = produced;
+    CHECK(&args(2) == &popped[2]);
+    bux::LR1::FC_GetRelLex rel{args, 1};
+    CHECK(bux::unlex<int>(rel(1)) == 20);
+    CHECK_THROWS_AS(args(3), std::out_of_range);
+    //------------------------------
+    int calls{};
+    auto counted = [&](size_t n)->bux::LR1::C_LexInfo& { ++calls; return popped[n]; };
+    const bux::LR1::F_GetProducedRef byLambda = counted;
+    auto copied = byLambda;
+    CHECK(&copied(0) == &popped[0]);
+    CHECK(calls == 1);
+    //------------------------------
+    // Handlers written against F_GetProduced still take what parsers hand over
+    const bux::LR1::I_ParserPolicy::FH_Reduce handler =
+        [](bux::LR1::C_Parser&, const bux::LR1::F_GetProduced &a, bux::LR1::C_LexPtr &ret) {
+            ret.assign(bux::createLex<int>(bux::unlex<int>(a(0)) + bux::unlex<int>(a(2))), true);
+        };
+    const C_SumPolicy policy;
+    bux::LR1::C_Parser parser{policy};
+    bux::LR1::C_LexPtr sum;
+    handler(parser, produced, sum);
+    CHECK(bux::unlex<int>(sum) == 20);
+}
+
+TEST_CASE("Produced symbols owned", "[I]")
+{
+    bux::LR1::C_StateLR1 popped[2];
+    popped[1].m_attr.assign(bux::createLex<int>(42), true);
+
+    // F_GetProduced and FC_GetRelLex own copies of the callables they are made of
+    std::optional<bux::LR1::F_GetProduced> stored;
+    std::optional<bux::LR1::FC_GetRelLex> rel;
+    {
+        auto *const base = popped;
+        stored = [base](size_t n)->bux::LR1::C_LexInfo& { return base[n]; };
+        const bux::LR1::F_GetProduced args = [base](size_t n)->bux::LR1::C_LexInfo& { return base[n]; };
+        rel.emplace(args, 1);
+    }
+    CHECK(bux::unlex<int>((*stored)(1)) == 42);
+    CHECK(bux::unlex<int>((*rel)(0)) == 42);
+}
+
+TEST_CASE("Re-parse from the last checkpoint before an edit", "[M]")
+{
+    const C_CloneablePolicy policy;
+    auto tokens = sumTokens(1001);
+    bux::LR1::C_Parser parser{policy};
+    bux::LR1::C_Checkpoints checkpoints{16};
+    addTokens(parser, tokens, 0, &checkpoints);
+    checkpoints.onEnd(parser);
+    REQUIRE(checkpoints.size() == tokens.size() / 16 + 1);
+    const auto sum = finish(parser);
+    CHECK(parser.tokens() == tokens.size() + 1);
+
+    for (size_t edited: {1200, 0, 1600, 1999, 1200})
+    {
+        tokens[edited].second = (tokens[edited].second + 3) % 10;
+        const auto resumed = checkpoints.resume(parser, edited, 1, 1);
+        CHECK(resumed <= edited);
+        CHECK(edited - resumed < 16);
+        CHECK(!parser.accepted());
+        CHECK(parser.tokens() == resumed);
+        // The sum folds all tokens into the bottom entry, so the parse converges only near the end
+        CHECK(tokens.size() - resumed - addTokens(parser, tokens, resumed, &checkpoints) < 16);
+        checkpoints.onEnd(parser);
+        const auto resumedSum = finish(parser);
+
+        bux::LR1::C_Parser fresh{policy};
+        addTokens(fresh, tokens, 0);
+        CHECK(resumedSum == finish(fresh));
+        CHECK(resumedSum != sum);
+        CHECK(checkpoints.size() == tokens.size() / 16 + 1);
+    }
+}
+
+TEST_CASE("Re-parse up to where the parse converges", "[M]")
+{
+    const C_ListPolicy policy;
+    auto tokens = listTokens(200, 5);
+    bux::LR1::C_Parser parser{policy};
+    bux::LR1::C_Checkpoints checkpoints{16};
+    addTokens(parser, tokens, 0, &checkpoints);
+    checkpoints.onEnd(parser);
+    finish(parser);
+    // Only the entries of the item being parsed differ from the checkpoint before
+    CHECK(checkpoints[8].m_Shared + 4 >= checkpoints[7].m_Depth);
+    CHECK(checkpoints[8].m_Depth > 20);
+
+    const struct
+    {
+        size_t                                      m_Near;
+        bux::T_LexID                                m_Token;    // The first edited
+        size_t                                      m_Removed;
+        std::vector<std::pair<bux::T_LexID,int>>    m_Added;
+        bool                                        m_Converges;
+    } edits[]{
+        {500,   'n', 1, {{'n', 7}},             true},
+        {1000,  '+', 0, {{'+', 0}, {'n', 9}},   true},
+        {300,   'n', 2, {},                     true},
+        {0,     'n', 0, {{'n', 1}, {';', 0}},   false}, // One more item on the stack ever after
+        {1000,  '+', 1, {{';', 0}},             false}, // Item split in two
+        {1990,  'n', 1, {{'n', 3}},             false}, // No checkpoint after but the end
+        {1500,  'n', 1, {{'n', 4}},             true}
+    };
+    long expected{};
+    for (auto &i: edits)
+    {
+        auto first = i.m_Near;
+        while (tokens[first].first != i.m_Token)
+            ++first;
+
+        tokens.erase(tokens.begin() + std::ptrdiff_t(first), tokens.begin() + std::ptrdiff_t(first + i.m_Removed));
+        tokens.insert(tokens.begin() + std::ptrdiff_t(first), i.m_Added.begin(), i.m_Added.end());
+        const auto resumed = checkpoints.resume(parser, first, i.m_Removed, i.m_Added.size());
+        CHECK(first - resumed < 16);
+        const auto added = addTokens(parser, tokens, resumed, &checkpoints);
+        checkpoints.onEnd(parser);
+        CHECK(parser.tokens() == tokens.size());
+        if (i.m_Converges)
+            CHECK(added < 64);
+        else
+            CHECK(tokens.size() - resumed - added < 16);
+
+        bux::LR1::C_Parser fresh{policy};
+        addTokens(fresh, tokens, 0);
+        expected = finish(fresh);
+        CHECK(finish(parser) == expected);
+        CHECK(checkpoints[checkpoints.size()-1].m_Tokens == tokens.size());
+    }
+    //------------------------------
+    // Checkpoints rebased after convergences resume the parse as well as the others
+    for (size_t i = 0; i < checkpoints.size(); ++i)
+    {
+        if (i)
+            REQUIRE(checkpoints[i-1].m_Tokens < checkpoints[i].m_Tokens);
+
+        bux::LR1::C_Parser other{policy};
+        other.restore(checkpoints[i]);
+        addTokens(other, tokens, checkpoints[i].m_Tokens);
+        CHECK(finish(other) == expected);
+    }
+}
+
+TEST_CASE("Same states at checkpoints", "[S]")
+{
+    const C_CloneablePolicy policy;
+    const auto tokens = sumTokens(20);
+    bux::LR1::C_Parser parser{policy};
+    bux::LR1::C_Checkpoints checkpoints{8};
+    addTokens(parser, tokens, 0, &checkpoints);
+    REQUIRE(checkpoints.size() == 4);
+    checkpoints.onEnd(parser);
+    CHECK(checkpoints.size() == 5);
+
+    bux::LR1::C_Parser other{policy};
+    addTokens(other, {tokens.begin(), tokens.begin() + 32}, 0);
+    CHECK(other.sameStates(*checkpoints.find(32)));
+    CHECK(other.sameStates(checkpoints[0]));
+    CHECK(!checkpoints.find(31));
+    other.add('n', 1, 33, bux::createLex<int>(4));
+    CHECK(!other.sameStates(*checkpoints.find(32)));
+    //------------------------------
+    other.restore(checkpoints[1]);
+    CHECK(other.tokens() == 16);
+    other.add('n', 1, 17, bux::createLex<int>(4));
+    CHECK(!other.sameStates(checkpoints[1]));
+}
+
+TEST_CASE("Checkpoint lexes not cloneable", "[E]")
+{
+    const C_SumPolicy policy;
+    bux::LR1::C_Parser parser{policy};
+    bux::LR1::C_Checkpoints checkpoints{1};
+    bux::LR1::C_Parser::C_Checkpoint cp;
+    CHECK(parser.checkpoint(cp));
+    addTokens(parser, sumTokens(5), 0, &checkpoints);
+    CHECK(!parser.checkpoint(cp));
+    CHECK(checkpoints.size() == 0);
+    checkpoints.onEnd(parser);
+    CHECK(checkpoints.size() == 0);
+    CHECK(checkpoints.resume(parser, 5, 1, 1) == 0);
+    CHECK(parser.tokens() == 0);
+    addTokens(parser, sumTokens(5), 0);
+    CHECK(finish(parser) == 10);
+}
+
+TEST_CASE("Comb rows agree with sparse rows", "[M]")
+{
+    typedef bux::C_KVPair<bux::T_LexID,size_t> C_Entry;
+    std::mt19937 rng{1};
+    std::vector<std::vector<C_Entry>> rows(300);
+    bux::C_CombBuilder<size_t> builder{128};
+    size_t packed{};
+    for (bux::T_StateID state = 0; state < rows.size(); ++state)
+    {
+        auto &row = rows[state];
+        for (auto n = 1 + rng() % 20; n--;)
+        {
+            const auto key = bux::T_LexID(rng() % 2? rng() % 128: bux::MIN_TOKEN_ID + rng() % 200);
+            if (std::none_of(row.begin(), row.end(), [=](auto &i){ return i.m_key == key; }))
+                row.push_back({key, bux::LR1::ACTION_REDUCE_MIN + rng() % 100});
+        }
+        std::sort(row.begin(), row.end(), [](auto &a, auto &b){ return a.m_key < b.m_key; });
+        packed += builder.addRow(state, row.data(), row.size());
+        CHECK(builder.table().hasRow(state) == (row.size() >= 4));
+    }
+    CHECK(packed > 0);
+    CHECK(builder.check().size() < rows.size() * (128 + 200) / 8);
+
+    const auto comb = builder.table();
+    for (bux::T_StateID state = 0; state < rows.size(); ++state)
+        for (bux::T_LexID key: {0U, 1U, 127U, 128U, 1000U, bux::MIN_TOKEN_ID, bux::MIN_TOKEN_ID + 199, bux::MIN_TOKEN_ID + 500})
+        {
+            auto &row = rows[state];
+            const bux::U_K2V<bux::T_LexID,size_t> k2v{row.data()};
+            const auto expected = bux::index2value<bux::T_LexID,size_t,long,C_ActionTraits>(k2v, -long(row.size()), key);
+            REQUIRE(bux::index2value<bux::T_LexID,size_t,long,C_ActionTraits>(comb, state, k2v, -long(row.size()), key) == expected);
+            for (auto &i: row)
+                REQUIRE(bux::index2value<bux::T_LexID,size_t,long,C_ActionTraits>(comb, state, k2v, -long(row.size()), i.m_key) == i.m_value);
+        }
+}
+
+TEST_CASE("Malformed comb rows", "[E]")
+{
+    typedef bux::C_KVPair<bux::T_LexID,size_t> C_Entry;
+    bux::C_CombBuilder<size_t> builder{128, 1};
+    const C_Entry unsorted[]{{'b', 5}, {'a', 6}};
+    CHECK_THROWS_AS(builder.addRow(0, unsorted, std::size(unsorted)), std::invalid_argument);
+    const C_Entry wide[]{{'a', 5}, {200, 6}};
+    CHECK_THROWS_AS(builder.addRow(1, wide, std::size(wide)), std::invalid_argument);
+    const C_Entry ok[]{{'a', 5}};
+    CHECK(builder.addRow(2, ok, std::size(ok)));
+    CHECK_THROWS_AS(builder.addRow(2, ok, std::size(ok)), std::invalid_argument);
+}
+
+TEST_CASE("Empty comb rows", "[Z]")
+{
+    typedef bux::C_KVPair<bux::T_LexID,size_t> C_Entry;
+    bux::C_CombBuilder<size_t> builder{128, 0};
+    CHECK(!builder.addRow(0, static_cast<const C_Entry*>(nullptr), 0));
+    const C_Entry one[]{{'a', bux::LR1::ACTION_SHIFT}};
+    CHECK(builder.addRow(1, one, std::size(one)));
+    const auto comb = builder.table();
+    CHECK(!comb.hasRow(0));
+    CHECK(comb.hasRow(1));
+    CHECK(comb.lookup(0, 'a', bux::LR1::ACTION_ERROR) == bux::LR1::ACTION_ERROR);
+    CHECK(builder.check().size() == 1);
+}
+
+TEST_CASE("Rows beyond the comb", "[B]")
+{
+    typedef bux::C_KVPair<bux::T_LexID,size_t> C_Entry;
+    bux::C_CombBuilder<size_t> builder{128, 1};
+    const C_Entry entries[]{{'a', bux::LR1::ACTION_SHIFT}};
+    CHECK(builder.addRow(0, entries, std::size(entries)));
+    const auto comb = builder.table();
+    CHECK(comb.m_rows == 1);
+    CHECK(comb.hasRow(0));
+    CHECK(!comb.hasRow(1));
+    CHECK(!comb.hasRow(bux::T_StateID(-2)));
+    CHECK(comb.lookup(1, 'a', bux::LR1::ACTION_ERROR) == bux::LR1::ACTION_ERROR);
+
+    // Rows never added to the builder are still resolved by binary search
+    const bux::U_K2V<bux::T_LexID,size_t> k2v{entries};
+    CHECK(bux::index2value<bux::T_LexID,size_t,long,C_ActionTraits>(comb, 5, k2v, -1L, 'a') == bux::LR1::ACTION_SHIFT);
+    CHECK(bux::index2value<bux::T_LexID,size_t,long,C_ActionTraits>(comb, 5, k2v, -1L, 'b') == bux::LR1::ACTION_ERROR);
+}
+
+TEST_CASE("Parse 1M tokens", "[.][benchmark]")
+{
+    constexpr size_t TERMS = 1 << 19;
+    const C_SumPolicy policy;
+    auto start = std::chrono::steady_clock::now();
+    bux::LR1::C_Parser virtualParser{policy};
+    const auto sum = sumOf(virtualParser, TERMS);
+    const std::chrono::duration<double> virtualTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    C_SumStaticPolicy::C_Parser staticParser;
+    CHECK(sumOf(staticParser, TERMS) == sum);
+    const std::chrono::duration<double> staticTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    C_SumCombPolicy::C_Parser combParser;
+    CHECK(sumOf(combParser, TERMS) == sum);
+    const std::chrono::duration<double> combTime = std::chrono::steady_clock::now() - start;
+    std::cout <<TERMS * 2 <<" tokens parsed in " <<virtualTime.count() <<"s by virtual policy, "
+              <<staticTime.count() <<"s by static policy, " <<combTime.count() <<"s by static policy of comb tables\n";
+}
+
+TEST_CASE("Re-parse 1M tokens after an edit in the middle", "[.][benchmark]")
+{
+    const C_ListPolicy policy;
+    auto tokens = listTokens(100'000, 5);
+    auto start = std::chrono::steady_clock::now();
+    bux::LR1::C_Parser parser{policy};
+    addTokens(parser, tokens, 0);
+    const auto sum = finish(parser);
+    const std::chrono::duration<double> fullTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    bux::LR1::C_Parser resumable{policy};
+    bux::LR1::C_Checkpoints checkpoints;
+    addTokens(resumable, tokens, 0, &checkpoints);
+    checkpoints.onEnd(resumable);
+    CHECK(finish(resumable) == sum);
+    const std::chrono::duration<double> checkedTime = std::chrono::steady_clock::now() - start;
+
+    const auto edited = tokens.size() / 20 * 10; // 1st 'n' token of the item in the middle
+    tokens[edited].second = (tokens[edited].second + 1) % 10;
+    start = std::chrono::steady_clock::now();
+    const auto added = addTokens(resumable, tokens, checkpoints.resume(resumable, edited, 1, 1), &checkpoints);
+    CHECK(finish(resumable) == sum + (tokens[edited].second? 1: -9));
+    const std::chrono::duration<double> reparseTime = std::chrono::steady_clock::now() - start;
+    std::cout <<tokens.size() <<" tokens parsed in " <<fullTime.count() <<"s, " <<checkedTime.count() <<"s with "
+              <<checkpoints.size() <<" checkpoints, then re-parsed after the edit at token " <<edited <<" by adding "
+              <<added <<" tokens in " <<reparseTime.count() <<"s\n";
+}
+
+TEST_CASE("Look up 10M actions", "[.][benchmark]")
+{
+    typedef bux::C_KVPair<bux::T_LexID,size_t> C_Entry;
+    std::mt19937 rng{1};
+    std::vector<std::vector<C_Entry>> rows(1000);
+    bux::C_CombBuilder<size_t> builder{128};
+    for (bux::T_StateID state = 0; state < rows.size(); ++state)
+    {
+        auto &row = rows[state];
+        for (auto n = 4 + rng() % 60; n--;)
+        {
+            const auto key = bux::T_LexID(rng() % 2? rng() % 128: bux::MIN_TOKEN_ID + rng() % 300);
+            if (std::none_of(row.begin(), row.end(), [=](auto &i){ return i.m_key == key; }))
+                row.push_back({key, bux::LR1::ACTION_REDUCE_MIN + rng() % 100});
+        }
+        std::sort(row.begin(), row.end(), [](auto &a, auto &b){ return a.m_key < b.m_key; });
+        builder.addRow(state, row.data(), row.size());
+    }
+    std::vector<std::pair<bux::T_StateID,bux::T_LexID>> queries(10'000'000);
+    for (auto &i: queries)
+    {
+        i.first = bux::T_StateID(rng() % rows.size());
+        auto &row = rows[i.first];
+        i.second = row[rng() % row.size()].m_key;
+    }
+
+    size_t sparseSum{}, combSum{};
+    auto start = std::chrono::steady_clock::now();
+    for (auto &i: queries)
+    {
+        auto &row = rows[i.first];
+        sparseSum += bux::index2value<bux::T_LexID,size_t,long,C_ActionTraits>(row.data(), -long(row.size()), i.second);
+    }
+    const std::chrono::duration<double> sparseTime = std::chrono::steady_clock::now() - start;
+
+    const auto comb = builder.table();
+    start = std::chrono::steady_clock::now();
+    for (auto &i: queries)
+    {
+        auto &row = rows[i.first];
+        combSum += bux::index2value<bux::T_LexID,size_t,long,C_ActionTraits>(comb, i.first, row.data(), -long(row.size()), i.second);
+    }
+    const std::chrono::duration<double> combTime = std::chrono::steady_clock::now() - start;
+    CHECK(combSum == sparseSum);
+    std::cout <<queries.size() <<" actions looked up in " <<sparseTime.count() <<"s by binary search, "
+              <<combTime.count() <<"s by " <<builder.check().size() <<" slots of comb\n";
+}
@@ -0,0 +1,114 @@
+/*
+    Test cases are organized according to ZOMBIES rules
+    http://blog.wingman-sw.com/tdd-guided-by-zombies
+*/
+#include <bux/MemIn.h>      // bux::C_IMemStream
+#include <bux/MemOut.h>     // bux::C_OGrowMemStream
+#include <bux/Serialize.h>  // bux::load_hashed_str(), bux::save_hashed_str()
+#include <sstream>          // std::ostringstream
+#include <string>           // std::string
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Empty growable stream", "[Z]")
+{
+    bux::C_OGrowMemStream out;
+    CHECK(out.size() == 0);
+    CHECK(out.view().empty());
+    CHECK(out.release().empty());
+    CHECK(out.good());
+}
+
+TEST_CASE("Growable stream grows", "[O][M]")
+{
+    bux::C_OGrowMemStream out{4};
+    std::string expected;
+    for (int i = 0; i < 10000; ++i)
+    {
+        out <<i <<',';
+        expected += std::to_string(i) + ',';
+    }
+    const std::string big(100000, 'x');
+    out.write(big.data(), std::streamsize(big.size()));
+    expected += big;
+    CHECK(out.good());
+    CHECK(out.size() == expected.size());
+    CHECK(out.view() == expected);
+    //-----------------------------
+    const auto s = out.release();
+    CHECK(s == expected);
+    CHECK(out.size() == 0);
+    out <<"again";
+    CHECK(out.view() == "again");
+}
+
+TEST_CASE("Reset growable stream", "[I]")
+{
+    bux::C_OGrowMemStream out;
+    out <<"Hello" <<std::string(1000, '!');
+    out.reset();
+    CHECK(out.view().empty());
+    out <<"World";
+    CHECK(out.view() == "World");
+}
+
+TEST_CASE("Empty input stream", "[Z]")
+{
+    bux::C_IMemStream in{""};
+    CHECK(in.view_remaining().empty());
+    CHECK(in.rdbuf()->in_avail() == -1);
+    char c;
+    CHECK(!in.get(c));
+}
+
+TEST_CASE("Seek & tell input stream", "[O][M]")
+{
+    const std::string_view src = "0123456789";
+    bux::C_IMemStream in{src};
+    CHECK(in.tellg() == 0);
+    CHECK(in.rdbuf()->in_avail() == 10);
+    in.seekg(3);
+    CHECK(in.tellg() == 3);
+    CHECK(in.view_remaining() == "3456789");
+    in.seekg(2, std::ios::cur);
+    CHECK(in.get() == '5');
+    in.seekg(-2, std::ios::end);
+    CHECK(in.view_remaining() == "89");
+    in.seekg(0, std::ios::end);
+    CHECK(in.tellg() == 10);
+    CHECK(in.view_remaining().empty());
+}
+
+TEST_CASE("Bulk read input stream", "[I]")
+{
+    const std::string src(100000, 'y');
+    bux::C_IMemStream in{src};
+    std::string dst(60000, '\0');
+    CHECK(in.read(dst.data(), std::streamsize(dst.size())));
+    CHECK(in.gcount() == 60000);
+    CHECK(dst == src.substr(0, 60000));
+    CHECK(!in.read(dst.data(), std::streamsize(dst.size())));
+    CHECK(in.gcount() == 40000);
+}
+
+TEST_CASE("Seek out of bounds", "[B][E]")
+{
+    bux::C_IMemStream in{"abc"};
+    CHECK(!in.seekg(4));
+    in.clear();
+    CHECK(!in.seekg(-1, std::ios::cur));
+    in.clear();
+    CHECK(in.tellg() == 0);
+    CHECK(in.seekg(3));
+    CHECK(in.view_remaining().empty());
+}
+
+TEST_CASE("Load hashed string from memory", "[I]")
+{
+    std::ostringstream out;
+    bux::save_hashed_str(out, "Hello world");
+    const auto saved = out.str();
+    bux::C_IMemStream in{saved};
+    const auto [s, hash, ok] = bux::load_hashed_str(in);
+    CHECK(s == "Hello world");
+    CHECK(ok);
+}
@@ -0,0 +1,141 @@
+/*
+    Test cases are organized according to ZOMBIES rules
+    http://blog.wingman-sw.com/tdd-guided-by-zombies
+*/
+#include <bux/ParaScan.h>   // bux::scanFiles()
+#include <filesystem>       // std::filesystem::temp_directory_path()
+#include <fstream>          // std::ofstream
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+//
+//      In-Module Types
+//
+class C_CountParser: public bux::I_Parser
+{
+public:
+
+    // Data
+    size_t                  m_tokens{};
+    bool                    m_eof{};
+
+    // Nonvirtuals
+    C_CountParser(bux::C_ParserLogCount &log): m_log(log) {}
+
+    // Implement bux::I_Parser
+    void add(bux::T_LexID token, unsigned line, unsigned col, bux::I_LexAttr *unownedAttr) override
+    {
+        delete unownedAttr;
+        if (token == bux::TID_EOF)
+            m_eof = true;
+        else
+        {
+            ++m_tokens;
+            if (token == '!')
+                m_log.log(LL_ERROR, {m_src, line, col}, "Bang");
+        }
+    }
+    std::string_view setSource(std::string_view src) override
+    {
+        const auto ret = m_src;
+        m_src = src;
+        return ret;
+    }
+
+private:
+
+    // Data
+    bux::C_ParserLogCount   &m_log;
+    std::string_view        m_src;
+};
+
+class C_CharScanner: public bux::I_Scanner<bux::C_LexUTF32>
+{
+public:
+
+    // Nonvirtuals
+    C_CharScanner(bux::I_Parser &parser): m_parser(parser) {}
+
+    // Implement bux::I_Scanner<>
+    void add(unsigned col, bux::C_LexUTF32 c) override { m_parser.add(c.m_U32, m_line, col, nullptr); }
+    void setLine(unsigned line) override { m_line = line; }
+    void setSource(std::string_view src) override { (void)m_parser.setSource(src); }
+
+private:
+
+    // Data
+    bux::I_Parser           &m_parser;
+    unsigned                m_line{};
+};
+
+//
+//      In-Module Functions
+//
+auto newPair(size_t, bux::C_ParserLogCount &log)
+{
+    bux::C_ScanPairT<bux::C_LexUTF32> ret;
+    ret.m_parser = std::make_unique<C_CountParser>(log);
+    ret.m_scanner = std::make_unique<C_CharScanner>(*ret.m_parser);
+    return ret;
+}
+
+std::vector<std::filesystem::path> createFiles(size_t n)
+{
+    std::vector<std::filesystem::path> ret;
+    const auto dir = std::filesystem::temp_directory_path();
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto &path = ret.emplace_back(dir / ("test_parascan_" + std::to_string(i) + ".txt"));
+        std::ofstream out{path, std::ios::binary};
+        out <<std::string(i, 'x') <<std::string(i % 3, '!');
+    }
+    return ret;
+}
+
+} // namespace
+
+TEST_CASE("Empty list of files", "[Z]")
+{
+    const auto report = bux::scanFiles<bux::C_LexUTF32>({}, newPair);
+    CHECK(report.m_files.empty());
+    CHECK(report.m_totalBytes == 0);
+}
+
+TEST_CASE("Many files across threads", "[M]")
+{
+    const auto paths = createFiles(50);
+    std::vector<size_t> tokens(paths.size());
+    std::vector<char> eof(paths.size()); // not vector<bool>: written from worker threads
+    const auto report = bux::scanFiles<bux::C_LexUTF32>(paths, newPair, [&](size_t i, bux::I_Parser &parser) {
+        const auto &p = dynamic_cast<C_CountParser&>(parser);
+        eof[i] = p.m_eof;
+        tokens[i] = p.m_tokens;
+    }, 4);
+    REQUIRE(report.m_files.size() == paths.size());
+    CHECK(report.m_threads == 4);
+    size_t bytes = 0;
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        const auto &f = report.m_files[i];
+        CHECK(f.m_path == paths[i]);
+        CHECK(!f.m_error);
+        CHECK(eof[i]);
+        CHECK(f.m_bytes == i + i % 3);
+        CHECK(tokens[i] == f.m_bytes);
+        CHECK(f.m_log.getCount(LL_ERROR) == i % 3);
+        CHECK(f.m_log.lines().size() == i % 3);
+        bytes += f.m_bytes;
+    }
+    CHECK(report.m_totalBytes == bytes);
+    for (auto &i: paths)
+        std::filesystem::remove(i);
+}
+
+TEST_CASE("Missing file", "[E]")
+{
+    const std::filesystem::path paths[]{std::filesystem::temp_directory_path() / "test_parascan_missing.txt"};
+    const auto report = bux::scanFiles<bux::C_LexUTF32>(paths, newPair);
+    REQUIRE(report.m_files.size() == 1);
+    CHECK(report.m_files.front().m_error);
+}
@@ -0,0 +1,211 @@
+/*
+    Test cases are organized according to ZOMBIES rules
+    http://blog.wingman-sw.com/tdd-guided-by-zombies
+*/
+#include <bux/FileAsMem.h>  // bux::C_FileAsMemory, bux::C_OFileAsMemory
+#include <bux/Serialize.h>  // bux::C_BinReader, bux::append_*()
+#include <cstdint>          // std::int64_t, std::uint64_t
+#include <cstring>          // memcpy()
+#include <filesystem>       // std::filesystem::temp_directory_path()
+#include <limits>           // std::numeric_limits<>
+#include <list>             // std::list<>
+#include <span>             // std::span<>, std::as_bytes()
+#include <stdexcept>        // std::out_of_range, std::runtime_error
+#include <string>           // std::string
+#include <vector>           // std::vector<>
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+//
+//      In-Module Functions
+//
+auto bytesOf(const std::string &s)
+{
+    return std::as_bytes(std::span{s.data(), s.size()});
+}
+
+} // namespace
+
+TEST_CASE("Empty reader", "[Z]")
+{
+    bux::C_BinReader in{std::span<const std::byte>{}};
+    CHECK(in.empty());
+    CHECK(in.remaining() == 0);
+    CHECK(in.take(0).empty());
+    CHECK_THROWS_AS(in.readVarint(), std::out_of_range);
+    CHECK_THROWS_AS(in.readLE<char>(), std::out_of_range);
+}
+
+TEST_CASE("Varint & zigzag round trip", "[O][M][B]")
+{
+    const std::uint64_t uvals[]{0, 1, 127, 128, 300, 16383, 16384, 0xFFFF'FFFF, std::numeric_limits<std::uint64_t>::max()};
+    const std::int64_t svals[]{0, -1, 1, -64, 64, -65, std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max()};
+    std::string buf;
+    for (auto i: uvals)
+        bux::append_varint(i, buf);
+    for (auto i: svals)
+        bux::append_zigzag(i, buf);
+
+    bux::C_BinReader in{bytesOf(buf)};
+    for (auto i: uvals)
+        CHECK(in.readVarint() == i);
+    for (auto i: svals)
+        CHECK(in.readZigzag() == i);
+    CHECK(in.empty());
+
+    buf.clear();
+    bux::append_varint(127, buf);
+    CHECK(buf.size() == 1);
+    bux::append_zigzag(-64, buf);
+    CHECK(buf.size() == 2);
+}
+
+TEST_CASE("Little-endian scalars are unaligned-safe", "[I]")
+{
+    enum E_Color: short { RED = 1, GREEN = -2 };
+    std::string buf{'x'}; // Misalign the rest
+    bux::append_le(0x1234'5678U, buf);
+    bux::append_le(-2.5, buf);
+    bux::append_le(GREEN, buf);
+    bux::append_le('z', buf);
+    CHECK(buf.size() == 1 + 4 + 8 + 2 + 1);
+    CHECK(buf[1] == 0x78);
+    CHECK(buf[4] == 0x12);
+
+    bux::C_BinReader in{bytesOf(buf)};
+    in.skip(1);
+    CHECK(in.readLE<unsigned>() == 0x1234'5678U);
+    CHECK(in.readLE<double>() == -2.5);
+    CHECK(in.readLE<E_Color>() == GREEN);
+    CHECK(in.readLE<char>() == 'z');
+    CHECK(in.empty());
+}
+
+TEST_CASE("Length-prefixed blobs & containers", "[I]")
+{
+    const std::vector<int> ints{3, -1, 4, 1, -5};
+    const std::list<std::string> strs{"", "alpha", std::string(300, 'b')};
+    std::string buf;
+    bux::append_blob("Hello", buf);
+    bux::append_seq(ints, buf);
+    bux::append_seq(strs, buf);
+    bux::append_seq(ints, buf, [](int i, auto &dst) { bux::append_zigzag(i, dst); });
+
+    bux::C_BinReader in{bytesOf(buf)};
+    CHECK(in.readBlob() == "Hello");
+    std::vector<int> ints2;
+    in.readSeq(ints2);
+    CHECK(ints2 == ints);
+    std::list<std::string> strs2;
+    in.readSeq(strs2);
+    CHECK(strs2 == strs);
+    std::vector<int> ints3;
+    in.readSeq(ints3, [](bux::C_BinReader &src) { return int(src.readZigzag()); });
+    CHECK(ints3 == ints);
+    CHECK(in.empty());
+}
+
+TEST_CASE("Version tags", "[I][E]")
+{
+    constexpr std::uint32_t MAGIC = 0x4255'5821;
+    std::string buf;
+    bux::append_tag(MAGIC, 3, buf);
+    bux::append_tag(MAGIC, 2, buf);
+
+    bux::C_BinReader in{bytesOf(buf)};
+    CHECK_THROWS_AS(in.readTag(MAGIC + 1, 3), std::runtime_error);
+    CHECK(in.offset() == 0);
+    CHECK_THROWS_AS(in.readTag(MAGIC, 2), std::runtime_error);
+    CHECK(in.offset() == 0);
+    CHECK(in.readTag(MAGIC, 3) == 3);
+    CHECK(in.readTag(MAGIC, 3) == 2);
+}
+
+TEST_CASE("Truncated or corrupt input", "[E]")
+{
+    std::string buf;
+    bux::append_blob("Hello", buf);
+    buf.pop_back();
+    bux::C_BinReader in{bytesOf(buf)};
+    CHECK_THROWS_AS(in.readBlob(), std::out_of_range);
+    CHECK(in.offset() == 0);
+    CHECK_THROWS_AS(in.take(buf.size() + 1), std::out_of_range);
+    CHECK(in.offset() == 0);
+
+    const std::string overlong(11, '\x80');
+    bux::C_BinReader in2{bytesOf(overlong)};
+    CHECK_THROWS_AS(in2.readVarint(), std::out_of_range);
+
+    std::string huge;
+    bux::append_varint(std::numeric_limits<std::uint64_t>::max(), huge); // Absurd count
+    std::vector<int> v;
+    bux::C_BinReader in3{bytesOf(huge)};
+    CHECK_THROWS_AS(in3.readSeq(v), std::out_of_range);
+    CHECK(in3.offset() == 0);
+
+    std::string partial;
+    bux::append_seq(std::vector<int>{1, 2, 3}, partial);
+    partial.pop_back();
+    std::vector<int> kept{0};
+    bux::C_BinReader in4{bytesOf(partial)};
+    CHECK_THROWS_AS(in4.readSeq(kept), std::out_of_range);
+    CHECK(in4.offset() == 0);
+    CHECK(kept == std::vector<int>{0});
+}
+
+TEST_CASE("View arrays in a mapped file", "[I]")
+{
+    const std::vector<double> doubles{1.5, -2.25, 1e300};
+    const std::vector<std::uint16_t> shorts{1, 2, 3, 65535};
+    const auto path = std::filesystem::temp_directory_path() / "test_serialize_arrays";
+    {
+        bux::C_OFileAsMemory out{path};
+        bux::append_blob("abc", out); // Misalign what follows
+        bux::append_array(std::span{doubles}, out);
+        bux::append_array(std::span{shorts}, out);
+        bux::append_array(std::span<const int>{}, out);
+    }
+    const bux::C_FileAsMemory map{path};
+    bux::C_BinReader in{map.span()};
+    CHECK(in.readBlob() == "abc");
+    const auto d = in.readArray<double>();
+    CHECK(std::vector(d.begin(), d.end()) == doubles);
+    CHECK(static_cast<const void*>(d.data()) > map.data());
+    CHECK(static_cast<const void*>(d.data() + d.size()) <= map.data() + map.size());
+    const auto s = in.readArray<std::uint16_t>();
+    CHECK(std::vector(s.begin(), s.end()) == shorts);
+    CHECK(in.readArray<int>().empty());
+    CHECK(in.empty());
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Views & reads over std::span<const char>", "[M][E]")
+{
+    std::string buf;
+    bux::append(0x12345678U, buf);
+    buf += "Hello";
+    const std::span<const char> src{buf};
+    size_t off = 0;
+    unsigned u;
+    bux::read(src, off, u);
+    CHECK(u == 0x12345678U);
+    CHECK(bux::read_view(src, off, 5) == "Hello");
+    CHECK(off == buf.size());
+    CHECK_THROWS_AS(bux::read(src, off, u), std::out_of_range);
+    CHECK_THROWS_AS(bux::read_view(src, off, 1), std::out_of_range);
+    CHECK(off == buf.size());
+
+    const std::uint64_t u64s[]{7, 8};
+    std::string arr;
+    bux::append_array(std::span{u64s}, arr);
+    bux::C_BinReader truncated{std::span{arr.data(), arr.size() - 1}};
+    CHECK_THROWS_AS(truncated.readArray<std::uint64_t>(), std::out_of_range);
+    CHECK(truncated.offset() == 0);
+
+    alignas(8) char shifted[32]{};
+    memcpy(shifted + 1, arr.data(), arr.size());
+    bux::C_BinReader misaligned{std::span<const char>{shifted + 1, arr.size()}};
+    CHECK_THROWS_AS(misaligned.readArray<std::uint64_t>(), std::runtime_error);
+    CHECK(misaligned.offset() == 0);
+}